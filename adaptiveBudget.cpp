@@ -0,0 +1,193 @@
+#include "adaptiveBudget.h"
+
+/* AdaptiveBudget replaces the fixed number of iterations and the doubling of particles
+when the adaptive option is set. The forward run of an adaptive iteration is split into
+batches of equal size, each with its own ARS tally. MleNoise uses the spread of the batches
+to estimate the Monte Carlo error of the MLE, and nextParticles picks the number of particles
+that brings this error down to the target. Converged fits the confidence contour of every layer on each iteration
+and stops the control loop once the MLE and the contour stop changing. */
+
+/* Members:
+    tol: Largest relative change of the MLE that counts as stable
+    contourTol: Largest relative change of the contour area that counts as stable
+    noiseTarget: Target standard error of the MLE, relative to the MLE
+    maxParticles: Most particles to send in one iteration
+    lastParam: Contour parameters of each layer from the last iteration, empty until the
+        first contour is found
+*/
+
+/******************************************************************************/
+
+AdaptiveBudget::AdaptiveBudget() {
+    tol = 0.01;
+    contourTol = 1;
+    noiseTarget = 0.01;
+    maxParticles = 0;
+    lastParam.clear();
+}
+
+/* Overload constructor */
+AdaptiveBudget::AdaptiveBudget( double tolIn, double contourTolIn, double noiseIn,
+    unsigned int maxIn ) {
+    tol = tolIn;
+    contourTol = contourTolIn;
+    noiseTarget = noiseIn;
+    maxParticles = maxIn;
+    lastParam.clear();
+}
+
+/* Estimates the relative standard error of the MLE of the run. batches holds the raw ARS
+tally of each batch, which is fixed in place, likGrid the log-likelihood after subFromMax
+and batchSize the particles in each batch. The log-likelihood N/2 log(SS/N) of
+likelihood.cpp is linearized in the ARS, so that the deviation of batch k at a grid point is
+
+    d_k = sum over angles of -N (exp - ars)/SS * ( ars_k - ars )
+
+where ars is the mean of the batches. likGrid + d_k/sqrt(numBatch) then has the Monte Carlo
+noise of the whole run, and the spread of the contour MLE of each layer over these grids is
+its standard error. The log-likelihood differences themselves do not get more precise with
+more particles, since SS shrinks with the Monte Carlo noise, so the MLE is used instead.
+Returns the largest error of etaa and mut over the layers, relative to the MLE, and a
+large value if fewer than two of the grids have a maximum. */
+double AdaptiveBudget::mleNoise( vector<vector<vector<vector<double> > > >& batches,
+    const vector<vector<double> >& likGrid, const vector<double>& expData,
+    unsigned int batchSize, vector<vector<double> >& mutVec, vector<vector<double> >& etaaVec ) {
+
+    unsigned int numBatch = batches.size();
+    unsigned int N = expData.size();
+    unsigned int m = likGrid.size(), n = likGrid.at(0).size();
+    double noise = 0;
+
+    for ( unsigned int k = 0; k < numBatch; k++ ) {
+        fixARS( batches.at(k), batchSize, m, n );
+    }
+
+    /* Log-likelihood grid of each batch, with the noise scaled to the whole run */
+    vector<vector<vector<double> > > batchGrid( numBatch, likGrid );
+    vector<double> mean( N );
+    for ( unsigned int i = 0; i < m; i++ ) {
+        for ( unsigned int j = 0; j < n; j++ ) {
+            double SS = 0;
+            for ( unsigned int b = 0; b < N; b++ ) {
+                mean.at(b) = 0;
+                for ( unsigned int k = 0; k < numBatch; k++ ) {
+                    mean.at(b) += batches.at(k).at(i).at(j).at(b) / numBatch;
+                }
+                SS += pow( expData.at(b) - mean.at(b), 2 );
+            }
+
+            for ( unsigned int b = 0; b < N; b++ ) {
+                double grad = -( N * ( expData.at(b) - mean.at(b) ) ) / SS / sqrt( double( numBatch ) );
+                for ( unsigned int k = 0; k < numBatch; k++ ) {
+                    batchGrid.at(k).at(i).at(j) += grad * ( batches.at(k).at(i).at(j).at(b) - mean.at(b) );
+                }
+            }
+        }
+    }
+
+    /* Spread of the MLE of each layer over the batch grids */
+    for ( unsigned int l = 0; l < mutVec.size(); l++ ) {
+        vector<vector<double> > mle, layerGrid;
+        vector<double> param(5);
+        for ( unsigned int k = 0; k < numBatch; k++ ) {
+            int i0 = 0, j0 = 0;
+            profileLayer( batchGrid.at(k), layerGrid, l, mutVec, etaaVec );
+            if ( discMax( layerGrid, i0, j0, mutVec.at(l).size(), etaaVec.at(l).size(), false ) &&
+                contour( layerGrid, param, etaaVec.at(l), mutVec.at(l), i0, j0, NULL ) ) {
+                mle.push_back( param );
+            }
+        }
+
+        if ( mle.size() < 2 ) {
+            return 1;
+        }
+
+        for ( unsigned int p = 3; p < 5; p++ ) {
+            double mleMean = 0, var = 0;
+            for ( unsigned int k = 0; k < mle.size(); k++ ) {
+                mleMean += mle.at(k).at(p) / mle.size();
+            }
+            for ( unsigned int k = 0; k < mle.size(); k++ ) {
+                var += pow( mle.at(k).at(p) - mleMean, 2 ) / ( mle.size() - 1 );
+            }
+            if ( sqrt( var ) / fabs( mleMean ) > noise ) {
+                noise = sqrt( var ) / fabs( mleMean );
+            }
+        }
+    }
+    return noise;
+}
+
+/* Returns the number of particles for the next iteration. The error falls as one over the
+square root of the particles, so the count is scaled by (noise/noiseTarget)^2. It never
+shrinks, grows at most eightfold, since noise is itself an estimate, stays within
+maxParticles and is a multiple of the number of batches. */
+unsigned int AdaptiveBudget::nextParticles( unsigned int numParticles, double noise,
+    unsigned int numBatch ) {
+    double ratio = pow( noise / noiseTarget, 2 );
+
+    if ( ratio < 1 ) {
+        ratio = 1;
+    }
+    if ( ratio > 8 ) {
+        ratio = 8;
+    }
+
+    double next = ceil( numParticles * ratio / numBatch ) * numBatch;
+    if ( next > maxParticles ) {
+        next = maxParticles - maxParticles % numBatch;
+    }
+    if ( next < numParticles ) {
+        next = numParticles;
+    }
+    return (unsigned int) next;
+}
+
+/* Fits the contour of each layer to its profile log-likelihood, without printing, and
+compares it to the last iteration. Returns TRUE if, for every layer, the relative change of
+etaa and mut is below tol and that of the contour area, which goes as one over the square
+root of the Hessian determinant, is below contourTol. A small change only means something
+once the error of the MLE, noise from mleNoise, is down to the target, so the run is not
+converged before then. The contours are then copied to paramOut. A layer without a maximum
+on its grid is never converged. */
+bool AdaptiveBudget::converged( const vector<vector<double> >& likGrid, vector<vector<double> >& mutVec,
+    vector<vector<double> >& etaaVec, double noise, vector<vector<double> >& paramOut ) {
+
+    vector<vector<double> > param( mutVec.size(), vector<double>(5) ), layerGrid;
+    bool found = true, stable = true;
+
+    for ( unsigned int l = 0; l < mutVec.size() && found; l++ ) {
+        int i0 = 0, j0 = 0;
+        profileLayer( likGrid, layerGrid, l, mutVec, etaaVec );
+        found = discMax( layerGrid, i0, j0, mutVec.at(l).size(), etaaVec.at(l).size(), false ) &&
+            contour( layerGrid, param.at(l), etaaVec.at(l), mutVec.at(l), i0, j0, NULL );
+    }
+
+    if ( !found ) {
+        lastParam.clear();
+        return false;
+    }
+
+    if ( lastParam.empty() || ( noise > noiseTarget ) ) {
+        stable = false;
+    }
+
+    for ( unsigned int l = 0; l < lastParam.size(); l++ ) {
+        const vector<double>& p = param.at(l);
+        const vector<double>& q = lastParam.at(l);
+        double det = p.at(0)*p.at(2) - p.at(1)*p.at(1);
+        double lastDet = q.at(0)*q.at(2) - q.at(1)*q.at(1);
+
+        if ( ( fabs( p.at(3) - q.at(3) ) > tol * fabs( p.at(3) ) ) ||
+            ( fabs( p.at(4) - q.at(4) ) > tol * fabs( p.at(4) ) ) ||
+            ( fabs( 1 - sqrt( lastDet / det ) ) > contourTol ) ) {
+            stable = false;
+        }
+    }
+
+    lastParam = param;
+    if ( stable ) {
+        paramOut = param;
+    }
+    return stable;
+}
@@ -0,0 +1,29 @@
+#include "contour.h"
+#include "discMax.h"
+#include "fixARS.h"
+#include "profileLayer.h"
+#include <vector>
+#include <iostream>
+#include <math.h>
+
+using namespace std;
+
+#pragma once
+
+class AdaptiveBudget {
+    public:
+    AdaptiveBudget();
+    AdaptiveBudget( double, double, double, unsigned int );
+    double mleNoise( vector<vector<vector<vector<double> > > >&, const vector<vector<double> >&,
+        const vector<double>&, unsigned int, vector<vector<double> >&, vector<vector<double> >& );
+    unsigned int nextParticles( unsigned int, double, unsigned int );
+    bool converged( const vector<vector<double> >&, vector<vector<double> >&,
+        vector<vector<double> >&, double, vector<vector<double> >& );
+
+    private:
+    double tol;
+    double contourTol;
+    double noiseTarget;
+    unsigned int maxParticles;
+    vector<vector<double> > lastParam;
+};
@@ -0,0 +1,256 @@
+#include "arsLibrary.h"
+
+/* ArsLibrary holds a precomputed ARS tensor, so that materials with the same n, g and t
+can be fit without a forward run. The buildLibrary option runs the forward model once on
+each sub-grid of the grid of the input file and writes the fixed ARS with write. The fitLibrary option
+opens the file, which maps it into memory instead of reading it, and interpolates the ARS
+at every point of the search grid from the library, so that scoreParam, updateInterval
+and contour work as usual. A library file is a LibraryHeader followed by the ARS as
+doubles, with the angle varying fastest and mut slowest, in the byte order of the
+machine that wrote it. With the reducedBasis option, the library is reduced: the basis of
+the ARS over the whole grid is found once when it is written (see reducedArs.cpp), and
+the file holds the mean curve, the basis curves (one after the other), and the rank
+coefficients of each grid point in place of its ARS. The fit then interpolates the
+coefficients, which is the same as projecting the interpolated ARS, since both are
+linear, and scores from them, so neither the file nor the fit holds the full ARS. */
+
+/* Members:
+    header: Size, grid and material parameters of the library
+    data: The ARS of the library, mutSize*etaaSize*numAngles values, or the coefficients of
+        a reduced library, mutSize*etaaSize*rank values
+    basisData: The mean curve and then the basis curves of a reduced library
+    map, mapSize: The memory map of the file, NULL if there is none
+    buffer: The ARS read into memory, where memory maps are not available
+*/
+
+/******************************************************************************/
+
+static const char libraryMagic[8] = { 'M', 'C', 'S', 'L', 'L', 'I', 'B', '\0' };
+static const uint32_t libraryVersion = 2;
+
+ArsLibrary::ArsLibrary() {
+    memset( &header, 0, sizeof( header ) );
+    data = NULL;
+    basisData = NULL;
+    map = NULL;
+    mapSize = 0;
+    buffer.clear();
+}
+
+ArsLibrary::~ArsLibrary() {
+#ifndef _WIN32
+    if ( map ) {
+        munmap( map, mapSize );
+    }
+#endif
+    data = NULL;
+    map = NULL;
+}
+
+/* Writes the fixed ARS over the grid of mutVec and etaaVec to a library file, or its
+reduced form if reduced has a basis. The particles of each forward run and the material
+are saved with it. Returns FALSE if the file could not be written. */
+bool ArsLibrary::write( const string& path, Layer& lay, double radius, unsigned int numParticles,
+    const vector<double>& mutVec, const vector<double>& etaaVec,
+    const vector<vector<vector<double> > >& ars, const ReducedArs& reduced ) {
+
+    LibraryHeader head;
+    memset( &head, 0, sizeof( head ) );
+    memcpy( head.magic, libraryMagic, sizeof( libraryMagic ) );
+    head.version = libraryVersion;
+    head.mutSize = mutVec.size();
+    head.etaaSize = etaaVec.size();
+    head.numAngles = ars.at(0).at(0).size();
+    head.rank = reduced.rank;
+    head.n = lay.getN();
+    head.g = lay.getG();
+    head.t = lay.getZMax() - lay.getZMin();
+    head.radius = radius;
+    head.numParticles = numParticles;
+    head.mutMin = mutVec.front();
+    head.mutMax = mutVec.back();
+    head.etaaMin = etaaVec.front();
+    head.etaaMax = etaaVec.back();
+
+    ofstream out( path.c_str(), ios::binary );
+    if ( !out.is_open() ) {
+        cerr << "Error: could not write library " << path << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+
+    out.write( (const char*) &head, sizeof( head ) );
+    if ( head.rank > 0 ) {
+        out.write( (const char*) &reduced.mean.at(0), head.numAngles * sizeof( double ) );
+        out.write( (const char*) reduced.basis.data(), head.numAngles * head.rank * sizeof( double ) );
+    }
+    for ( unsigned int i = 0; i < head.mutSize; i++ ) {
+        for ( unsigned int j = 0; j < head.etaaSize; j++ ) {
+            if ( head.rank > 0 ) {
+                out.write( (const char*) &reduced.coeffs.at(i).at(j).at(0), head.rank * sizeof( double ) );
+            }
+            else {
+                out.write( (const char*) &ars.at(i).at(j).at(0), head.numAngles * sizeof( double ) );
+            }
+        }
+    }
+
+    if ( !out.good() ) {
+        cerr << "Error: could not write library " << path << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+    return true;
+}
+
+/* Maps a library file into memory and checks its header. Without memory maps (_WIN32),
+the ARS (or the basis and coefficients) is read into buffer instead. Returns FALSE if the file could not be opened, is not
+a library of this version, or is shorter than its header says. */
+bool ArsLibrary::open( const string& path ) {
+    size_t fileSize;
+
+#ifndef _WIN32
+    int fd = ::open( path.c_str(), O_RDONLY );
+    struct stat info;
+    if ( ( fd < 0 ) || ( fstat( fd, &info ) != 0 ) ) {
+        cerr << "Error: could not open library " << path << " (in arsLibrary.cpp)." << endl;
+        if ( fd >= 0 ) {
+            close( fd );
+        }
+        return false;
+    }
+    fileSize = info.st_size;
+    if ( fileSize >= sizeof( header ) ) {
+        map = mmap( NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0 );
+    }
+    close( fd );
+    if ( ( map == NULL ) || ( map == MAP_FAILED ) ) {
+        map = NULL;
+        cerr << "Error: could not map library " << path << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+    mapSize = fileSize;
+    memcpy( &header, map, sizeof( header ) );
+#else
+    ifstream in( path.c_str(), ios::binary | ios::ate );
+    if ( !in.is_open() ) {
+        cerr << "Error: could not open library " << path << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+    fileSize = in.tellg();
+    in.seekg( 0 );
+    in.read( (char*) &header, sizeof( header ) );
+#endif
+
+    if ( ( fileSize < sizeof( header ) ) || ( memcmp( header.magic, libraryMagic, sizeof( libraryMagic ) ) != 0 ) ) {
+        cerr << "Error: " << path << " is not an ARS library (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+
+    if ( header.version != libraryVersion ) {
+        cerr << "Error: library " << path << " has version " << header.version << ", expected "
+            << libraryVersion << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+
+    size_t numBasis = ( header.rank > 0 ) ? size_t( header.numAngles ) * ( 1 + header.rank ) : 0;
+    size_t numValues = numBasis + size_t( header.mutSize ) * header.etaaSize *
+        ( ( header.rank > 0 ) ? header.rank : header.numAngles );
+    if ( ( header.mutSize < 2 ) || ( header.etaaSize < 2 ) || ( header.rank > header.numAngles ) ||
+        ( fileSize < sizeof( header ) + numValues * sizeof( double ) ) ) {
+        cerr << "Error: library " << path << " is truncated (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+
+#ifndef _WIN32
+    basisData = (const double*) ( (const char*) map + sizeof( header ) );
+#else
+    buffer.resize( numValues );
+    in.read( (char*) &buffer.at(0), numValues * sizeof( double ) );
+    basisData = &buffer.at(0);
+#endif
+    data = basisData + numBasis;
+    return true;
+}
+
+/* Returns TRUE if the library was built for the material of lay, the detector radius and
+the number of angles of the experimental data. */
+bool ArsLibrary::matches( Layer& lay, double radius, unsigned int numAngles ) {
+    double tol = 1e-9;
+    if ( ( fabs( header.n - lay.getN() ) > tol ) || ( fabs( header.g - lay.getG() ) > tol ) ||
+        ( fabs( header.t - ( lay.getZMax() - lay.getZMin() ) ) > tol * header.t ) ||
+        ( fabs( header.radius - radius ) > tol * header.radius ) ) {
+        cerr << "Error: library was built for n = " << header.n << ", g = " << header.g << ", t = "
+            << header.t << ", radius = " << header.radius << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+
+    if ( header.numAngles != numAngles ) {
+        cerr << "Error: library has " << header.numAngles << " angles, the data has "
+            << numAngles << " (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+    return true;
+}
+
+/* Shrinks the search grid to the range of the library, keeping its number of points, so
+that the ARS is never extrapolated. Returns FALSE if the search grid does not overlap the
+library. */
+bool ArsLibrary::clampGrid( vector<double>& mutVec, vector<double>& etaaVec ) {
+    double mutLo = max( mutVec.front(), header.mutMin );
+    double mutHi = min( mutVec.back(), header.mutMax );
+    double etaaLo = max( etaaVec.front(), header.etaaMin );
+    double etaaHi = min( etaaVec.back(), header.etaaMax );
+    if ( ( mutLo > mutHi ) || ( etaaLo > etaaHi ) ) {
+        cerr << "Error: the search grid (mu_t " << mutVec.front() << " to " << mutVec.back() << ", eta_a "
+            << etaaVec.front() << " to " << etaaVec.back() << ") is outside of the library (mu_t "
+            << header.mutMin << " to " << header.mutMax << ", eta_a " << header.etaaMin << " to "
+            << header.etaaMax << ") (in arsLibrary.cpp)." << endl;
+        return false;
+    }
+
+    mutVec = gridVec( mutLo, mutHi, mutVec.size() );
+    etaaVec = gridVec( etaaLo, etaaHi, etaaVec.size() );
+    return true;
+}
+
+/* Sets ars to the bilinear interpolation of the library at every point of the grid of
+mutVec and etaaVec, which must lie within the library. For a reduced library, these are
+the coefficients of each point instead of its ARS. */
+void ArsLibrary::interpolate( const vector<double>& mutVec, const vector<double>& etaaVec,
+    vector<vector<vector<double> > >& ars ) {
+
+    unsigned int width = ( header.rank > 0 ) ? header.rank : header.numAngles;
+    double dmut = ( header.mutMax - header.mutMin ) / ( header.mutSize - 1 );
+    double detaa = ( header.etaaMax - header.etaaMin ) / ( header.etaaSize - 1 );
+    ars.assign( mutVec.size(), vector<vector<double> >( etaaVec.size(), vector<double>( width, 0 ) ) );
+
+    for ( unsigned int i = 0; i < mutVec.size(); i++ ) {
+        double x = ( mutVec.at(i) - header.mutMin ) / dmut;
+        unsigned int i0 = min( (unsigned int) max( floor( x ), 0.0 ), header.mutSize - 2 );
+        double u = x - i0;
+
+        for ( unsigned int j = 0; j < etaaVec.size(); j++ ) {
+            double y = ( etaaVec.at(j) - header.etaaMin ) / detaa;
+            unsigned int j0 = min( (unsigned int) max( floor( y ), 0.0 ), header.etaaSize - 2 );
+            double v = y - j0;
+
+            const double *p00 = data + ( size_t( i0 ) * header.etaaSize + j0 ) * width;
+            const double *p01 = p00 + width;
+            const double *p10 = p00 + size_t( header.etaaSize ) * width;
+            const double *p11 = p10 + width;
+            vector<double>& out = ars.at(i).at(j);
+            for ( unsigned int k = 0; k < width; k++ ) {
+                out.at(k) = ( 1-u ) * ( ( 1-v ) * p00[k] + v * p01[k] ) + u * ( ( 1-v ) * p10[k] + v * p11[k] );
+            }
+        }
+    }
+}
+
+/* Sets the mean curve and the basis of reduced to those of a reduced library, which has
+the coefficients of every grid point in interpolate */
+void ArsLibrary::reducedBasis( ReducedArs& reduced ) const {
+    unsigned int N = header.numAngles;
+    reduced.rank = header.rank;
+    reduced.mean.assign( basisData, basisData + N );
+    reduced.basis = Map<const MatrixXd>( basisData + N, N, header.rank );
+    reduced.coeffs.clear();
+}
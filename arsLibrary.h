@@ -0,0 +1,64 @@
+#include "gridVec.h"
+#include "layer.h"
+#include "reducedArs.h"
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+#pragma once
+
+/* Layout of the start of a library file. The fields are fixed size, and the header is a
+multiple of 8 bytes long, so that the ARS that follows it is aligned for doubles. */
+struct LibraryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t mutSize;
+    uint32_t etaaSize;
+    uint32_t numAngles;
+    uint32_t rank;
+    uint32_t reserved;
+    double n;
+    double g;
+    double t;
+    double radius;
+    double numParticles;
+    double mutMin;
+    double mutMax;
+    double etaaMin;
+    double etaaMax;
+};
+
+class ArsLibrary {
+    public:
+    ArsLibrary();
+    ~ArsLibrary();
+    static bool write( const string&, Layer&, double, unsigned int, const vector<double>&,
+        const vector<double>&, const vector<vector<vector<double> > >&, const ReducedArs& );
+    bool open( const string& );
+    bool matches( Layer&, double, unsigned int );
+    bool clampGrid( vector<double>&, vector<double>& );
+    void interpolate( const vector<double>&, const vector<double>&, vector<vector<vector<double> > >& );
+    void reducedBasis( ReducedArs& ) const;
+    LibraryHeader header;
+
+    private:
+    ArsLibrary( const ArsLibrary& );
+    ArsLibrary& operator=( const ArsLibrary& );
+    const double *data;
+    const double *basisData;
+    void *map;
+    size_t mapSize;
+    vector<double> buffer;
+};
@@ -0,0 +1,373 @@
+#include "solver.h"
+#include "gridVec.h"
+#include "HGDist.h"
+#include "intersect.h"
+#include "medInterface.h"
+#include "newSegSize.h"
+#include "scattFunction.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* BenchKernels times the transport and scoring kernels of the library one at a time,
+with random number streams seeded with a fixed seed and inputs drawn from them before the
+timing starts, so that two runs on the same machine time the same work. Each benchmark
+runs its kernel n times in a row, with n doubled until that takes at least MIN_TIME
+seconds, and then takes SAMPLES such runs. It reports the median and the fastest time per
+call (ns/op), and photons per second for the kernels that run once per photon and for
+whole photons. The kernels that depend on the size of the search grid or of the ARS are
+timed at a small, the example and a large grid. The table is printed, and the results are
+written to a JSON file (argument 1, or bench/kernels.json), to be kept and compared over
+time. Built and run with make bench. */
+
+/* Variables:
+    SEED, SAMPLES, MIN_TIME: Seed of the streams, runs of each benchmark, and least seconds
+        of one run
+    results: One entry per benchmark: its name, grid size, median and fastest ns per call,
+        calls per run, and photons per call (zero if a call is not a photon)
+    solver: Holds the random number stream of the benchmarks
+    layerVec, layAir: The material of inputExample.txt at the center of its grid, and the air
+    mutVec, etaaVec: Search grids with their reference point at the center
+    u: Uniform random numbers drawn before the timing, for the inputs of the kernels
+    sink: Adds up results, so that the compiler cannot drop the kernels
+*/
+
+/******************************************************************************/
+
+static const int SEED = 24;
+static const unsigned int SAMPLES = 7;
+static const double MIN_TIME = 0.02;
+static volatile double sink = 0;
+
+struct BenchResult {
+    string name, size;
+    double nsMedian, nsMin;
+    unsigned long long calls;
+    double photonsPerCall;
+};
+
+#ifdef SPRNGFIVE
+static double uniform( Sprng* stream ) {
+    return stream->sprng();
+}
+#else
+static double uniform( int* stream ) {
+    return sprng( stream );
+}
+#endif
+
+/* Seconds that one call of run( n ) takes */
+static double timeRun( const function<void( unsigned long long )>& run, unsigned long long n ) {
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    run( n );
+    return chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+}
+
+/* Times run, which makes n calls of a kernel, and adds the result to results */
+static void bench( vector<BenchResult>& results, const string& name, const string& size,
+    double photonsPerCall, const function<void( unsigned long long )>& run ) {
+    unsigned long long n = 1;
+    while ( ( timeRun( run, n ) < MIN_TIME ) && ( n < ( 1ULL << 40 ) ) ) {
+        n *= 2;
+    }
+
+    vector<double> ns;
+    for ( unsigned int s = 0; s < SAMPLES; s++ ) {
+        ns.push_back( 1e9 * timeRun( run, n ) / n );
+    }
+    sort( ns.begin(), ns.end() );
+
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.nsMedian = ns.at( SAMPLES/2 );
+    result.nsMin = ns.front();
+    result.calls = n;
+    result.photonsPerCall = photonsPerCall;
+    results.push_back( result );
+    cout << left << setw( 22 ) << name << setw( 10 ) << size << right << setw( 14 ) << result.nsMedian
+        << setw( 14 ) << result.nsMin;
+    if ( photonsPerCall > 0 ) {
+        cout << setw( 14 ) << 1e9 * photonsPerCall / result.nsMedian;
+    }
+    cout << endl;
+}
+
+/* Writes results to path as JSON. Returns FALSE if the file did not open. */
+static bool writeJson( const string& path, const vector<BenchResult>& results ) {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from benchKernels.cpp)." << endl;
+        return false;
+    }
+    saveData << "{" << endl << "  \"seed\": " << SEED << "," << endl << "  \"samples\": " << SAMPLES << ","
+        << endl << "  \"time\": " << time( NULL ) << "," << endl << "  \"compiler\": \"" << __VERSION__ << "\","
+        << endl << "  \"benchmarks\": [";
+    for ( unsigned int k = 0; k < results.size(); k++ ) {
+        const BenchResult& r = results.at(k);
+        saveData << ( k ? "," : "" ) << endl << "    {\"name\": \"" << r.name << "\", \"size\": \"" << r.size
+            << "\", \"nsPerOp\": " << r.nsMedian << ", \"nsPerOpMin\": " << r.nsMin << ", \"calls\": "
+            << r.calls << ", \"photonsPerSecond\": ";
+        if ( r.photonsPerCall > 0 ) {
+            saveData << 1e9 * r.photonsPerCall / r.nsMedian << "}";
+        }
+        else {
+            saveData << "null}";
+        }
+    }
+    saveData << endl << "  ]" << endl << "}" << endl;
+    return true;
+}
+
+int main( int argc, char* argv[] ) {
+    string path = ( argc > 1 ) ? argv[1] : "bench/kernels.json";
+    vector<BenchResult> results;
+    const double PI = 3.14159265358979323846;
+
+    /* The transport functions are declared where they are used, as in inverse.cpp */
+    int propagate( Particle& );
+    int detect( Particle&, double, unsigned int, vector<vector<vector<double> > >
+        &, unsigned int, unsigned int );
+    int detect( Particle&, double, unsigned int, vector<vector<vector<double> > >&, TallyKernel );
+    int scatter( Particle& );
+    int boundary( Particle&, Layer&, vector<Layer>& );
+
+    Solver solver;
+    if ( !solver.init( 1, SEED ) ) {
+        return 1;
+    }
+#ifdef SPRNGFIVE
+    Sprng* stream = solver.stream( 0 );
+#else
+    int* stream = solver.stream( 0 );
+#endif
+
+    /* The example material at mu_t = 2.6, eta_a = 0.008 */
+    double mut0 = 2.6, etaa0 = 0.008, radius = 669.8;
+    vector<Layer> layerVec( 1, Layer( 1.493, mut0 * ( 1 - etaa0 ), mut0 * etaa0, 0.621, 6.10 ) );
+    Layer layAir;
+    double T = 1 - specularR( layerVec.at(0) );
+    unsigned int angleDiv = 72;
+
+    /* Inputs drawn before the timing */
+    const unsigned int NUM_U = 4096;
+    vector<double> u( NUM_U );
+    for ( unsigned int i = 0; i < NUM_U; i++ ) {
+        u.at(i) = uniform( stream );
+    }
+
+    cout << left << setw( 22 ) << "kernel" << setw( 10 ) << "size" << right << setw( 14 ) << "ns/op"
+        << setw( 14 ) << "ns/op (min)" << setw( 14 ) << "photons/s" << endl;
+    cout << setprecision( 4 );
+
+/*************************  Transport kernels  ********************************/
+
+    bench( results, "newSegSize", "-", 0, [&]( unsigned long long n ) {
+        double s = 0;
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            s += newSegSize( stream );
+        }
+        sink += s;
+    } );
+
+    bench( results, "HGDist", "-", 0, [&]( unsigned long long n ) {
+        double s = 0;
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            s += HGDist( 0.621, stream );
+        }
+        sink += s;
+    } );
+
+    vector<vector<double> > mutVec( 1, gridVec( mut0 - 1.6, mut0 + 1.6, 17 ) ),
+        etaaVec( 1, gridVec( etaa0 - 0.007, etaa0 + 0.007, 15 ) );
+    Particle par( T, mutVec, etaaVec, stream );
+    par.weight.setReference( layerVec );
+    par.lay = layerVec.at(0);
+
+    bench( results, "scattFunction", "-", 0, [&]( unsigned long long n ) {
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            scattFunction( par, 2 * u.at( i % NUM_U ) - 1, 2 * PI * u.at( ( i+1 ) % NUM_U ) );
+        }
+        sink += par.dir.at(2);
+    } );
+
+    /* A photon that hits the top surface from inside, at a random angle */
+    bench( results, "medInterface", "-", 0, [&]( unsigned long long n ) {
+        unsigned long long escaped = 0;
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            double kz = -u.at( i % NUM_U ), kt = sqrt( 1 - kz*kz );
+            par.lay = layerVec.at(0);
+            par.dir.at(0) = kt;
+            par.dir.at(1) = 0;
+            par.dir.at(2) = kz;
+            escaped += medInterface( par, layAir, stream );
+        }
+        sink += escaped;
+    } );
+
+    /* A photon that left the top surface within a few mm of the entry point */
+    bench( results, "intersect", "-", 1, [&]( unsigned long long n ) {
+        double s = 0;
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            double kz = -u.at( i % NUM_U ), kt = sqrt( 1 - kz*kz );
+            par.rVec.at(0) = 10 * u.at( ( i+1 ) % NUM_U ) - 5;
+            par.rVec.at(1) = 10 * u.at( ( i+2 ) % NUM_U ) - 5;
+            par.rVec.at(2) = 0;
+            par.dir.at(0) = kt;
+            par.dir.at(1) = 0;
+            par.dir.at(2) = kz;
+            s += intersect( radius, par );
+        }
+        sink += s;
+    } );
+
+    bench( results, "updateWeightMut", "-", 0, [&]( unsigned long long n ) {
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            par.weight.updateWeightMut( 0, u.at( i % NUM_U ) );
+        }
+        sink += par.weight.pathLen.at(0);
+        par.weight.reset( T );
+    } );
+
+    bench( results, "updateWtBound", "-", 0, [&]( unsigned long long n ) {
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            par.weight.updateWtBound( 0, u.at( i % NUM_U ) );
+        }
+        sink += par.weight.pathLen.at(0);
+        par.weight.reset( T );
+    } );
+
+    /* The whole transport of one photon through the slab, detected over the example grid */
+    vector<vector<vector<double> > > arsPhoton( 17, vector<vector<double> >( 15, vector<double>( angleDiv, 0 ) ) );
+    bench( results, "photon", "17x15", 1, [&]( unsigned long long n ) {
+        for ( unsigned long long i = 0; i < n; i++ ) {
+            par.reset( T );
+            par.lay = layerVec.at(0);
+            int state = 2;
+            while ( state ) {
+                switch( state ) {
+                case 1:
+                    state = scatter( par );
+                    break;
+                case 2:
+                    state = propagate( par );
+                    break;
+                case 3:
+                    state = boundary( par, layAir, layerVec );
+                    break;
+                case 4:
+                    state = detect( par, radius, angleDiv, arsPhoton, 17, 15 );
+                    break;
+                }
+            }
+        }
+        sink += arsPhoton.at(8).at(7).at(0);
+    } );
+
+/**********************  Kernels over the search grid  ************************/
+
+    unsigned int sizes[][2] = { { 5, 5 }, { 17, 15 }, { 41, 41 } };
+    for ( unsigned int g = 0; g < 3; g++ ) {
+        unsigned int m = sizes[g][0], e = sizes[g][1];
+        string size = to_string( m ) + "x" + to_string( e );
+        vector<vector<double> > mutG( 1, gridVec( mut0 - 1.6, mut0 + 1.6, m ) ),
+            etaaG( 1, gridVec( etaa0 - 0.007, etaa0 + 0.007, e ) );
+
+        /* A photon with about the collisions and path length of an average one */
+        Particle parG( T, mutG, etaaG, stream );
+        parG.weight.setReference( layerVec );
+        parG.weight.numColl.at(0) = 80;
+        parG.weight.pathLen.at(0) = 31;
+        parG.weight.wScale = 0.5;
+
+        bench( results, "updateMatrix", size, 0, [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                parG.weight.updateMatrix();
+            }
+            sink += parG.weight.weightMatrix.at(0).at(0);
+        } );
+
+        vector<vector<vector<double> > > tally( m, vector<vector<double> >( e, vector<double>( angleDiv, 0 ) ) );
+        bench( results, "detect", size, 1, [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                double kz = -u.at( i % NUM_U ), kt = sqrt( 1 - kz*kz );
+                parG.rVec.at(0) = 0;
+                parG.rVec.at(1) = 0;
+                parG.dir.at(0) = kt;
+                parG.dir.at(1) = 0;
+                parG.dir.at(2) = kz;
+                detect( parG, radius, angleDiv, tally, m, e );
+            }
+            sink += tally.at(0).at(0).at( angleDiv/2 );
+        } );
+
+        /* The same with the kernel that inverse picks for the grid (fixed size for 17x15) */
+        TallyKernel kernel = tallyKernel( m, e, 1 );
+        bench( results, kernel == tallyGeneric ? "detect generic" : "detect fixed", size, 1,
+            [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                double kz = -u.at( i % NUM_U ), kt = sqrt( 1 - kz*kz );
+                parG.rVec.at(0) = 0;
+                parG.rVec.at(1) = 0;
+                parG.dir.at(0) = kt;
+                parG.dir.at(1) = 0;
+                parG.dir.at(2) = kz;
+                detect( parG, radius, angleDiv, tally, kernel );
+            }
+            sink += tally.at(0).at(0).at( angleDiv/2 );
+        } );
+
+        /* A tally with one value per angle, and the same tally after fixARS */
+        for ( unsigned int i = 0; i < m; i++ ) {
+            for ( unsigned int j = 0; j < e; j++ ) {
+                for ( unsigned int k = 0; k < angleDiv; k++ ) {
+                    tally.at(i).at(j).at(k) = 1 + u.at( ( ( i*e + j ) * angleDiv + k ) % NUM_U );
+                }
+            }
+        }
+        vector<vector<vector<double> > > sum = tally, work = tally, ars = tally;
+        fixARS( ars, 20000, m, e );
+
+        bench( results, "addVec", size, 0, [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                addVec( sum, tally, m, e );
+            }
+            sink += sum.at(0).at(0).at(0);
+        } );
+
+        /* fixARS shrinks its tally, so each call starts from a copy, which is timed on its own */
+        bench( results, "copy for fixARS", size, 0, [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                work = tally;
+            }
+            sink += work.at(0).at(0).at(0);
+        } );
+        bench( results, "fixARS with copy", size, 0, [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                work = tally;
+                fixARS( work, 20000, m, e );
+            }
+            sink += work.at(0).at(0).at(0);
+        } );
+
+        vector<double> expData( ars.at( m/2 ).at( e/2 ) );
+        for ( unsigned int k = 0; k < expData.size(); k++ ) {
+            expData.at(k) *= 1 + 0.1 * u.at(k);
+        }
+        vector<vector<double> > likGrid( m, vector<double>( e, 0 ) );
+        bench( results, "scoreParam", size, 0, [&]( unsigned long long n ) {
+            for ( unsigned long long i = 0; i < n; i++ ) {
+                scoreParam( ars, likGrid, expData, m, e );
+            }
+            sink += likGrid.at(0).at(0);
+        } );
+    }
+
+    return writeJson( path, results ) ? 0 : 1;
+}
@@ -0,0 +1,248 @@
+#include "solver.h"
+#include "gridVec.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+using namespace std;
+
+/* BenchScaling measures how one forward run (Solver::forward) scales with the number of
+threads, the size of the search grid, the number of angles and the number of photons,
+to plan allocations with and to catch regressions of the parallel loop. The material is
+the one of inputExample.txt and the inputs are made up in the program, so nothing is read
+from dataIn. Every combination of the matrix is run REPEATS times, and the fastest run
+counts. For strong scaling, the photons are the same for every number of threads, and the
+parallel efficiency is the time on one thread over threads times the time on threads.
+For weak scaling, every thread sends the same photons, and the efficiency is the time on
+one thread over the time on threads. Each row also has the photons per second of the
+transport loop, per thread, the memory of the tallies of the run, and the peak resident
+memory of the run. So that the peak is that of one combination only, and not the largest
+of all of them so far, every combination runs in a process of its own: the program runs
+itself with --run and the combination, and reads the times and the peak back. The table is
+printed, and the results are written to a JSON file. Arguments: the largest number of
+threads (default, or 0: the processors of the machine) and the JSON file
+(bench/scaling.json). Built and run with make scaling. */
+
+/* Variables:
+    SEED, REPEATS: Seed of the streams, and runs of each combination
+    threadList: 1, 2, 4, ... up to the largest number of threads, and that number
+    gridList, angleList, photonList: Search grids (mu_t by eta_a), numbers of angles, and
+        photons of the strong scaling runs
+    WEAK_PHOTONS: Photons of each thread in the weak scaling runs
+    rows: One entry per run: mode, threads, grid, angles, photons, seconds of the transport
+        loop and of the whole run, efficiency, and memory
+    self: The path of the program, to run each combination with
+*/
+
+/******************************************************************************/
+
+static const int SEED = 24;
+static const unsigned int REPEATS = 3;
+static const unsigned int WEAK_PHOTONS = 20000;
+
+struct ScalingRow {
+    string mode;
+    unsigned int threads, mutN, etaaN, angles, photons;
+    double transport, total, efficiency, tallyMB, peakMB;
+};
+
+/* Peak resident memory of the process in MB */
+static double peakMB() {
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    return usage.ru_maxrss / 1024.0;
+}
+
+/* Runs the forward model REPEATS times with the threads of solver, and fills the times of
+row with the fastest run. Returns FALSE if there is an error. */
+static bool run( Solver& solver, ScalingRow& row ) {
+    InverseSetup setup;
+    setup.layerVec.assign( 1, Layer( 1.493, 2.6 * ( 1 - 0.008 ), 2.6 * 0.008, 0.621, 6.10 ) );
+    setup.mutVec.assign( 1, gridVec( 1.0, 4.2, row.mutN ) );
+    setup.etaaVec.assign( 1, gridVec( 0.001, 0.015, row.etaaN ) );
+    setup.expData.assign( row.angles, 0 );
+    setup.numParticles = row.photons;
+    setup.radius = 669.8;
+
+    row.transport = 0;
+    row.total = 0;
+    for ( unsigned int k = 0; k < REPEATS; k++ ) {
+        InverseResult result;
+        InverseSetup trial = setup;
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        if ( !solver.forward( trial, result ) ) {
+            return false;
+        }
+        double total = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+        double transport = result.timing.wall.at(0).at(0);
+        if ( ( k == 0 ) || ( transport < row.transport ) ) {
+            row.transport = transport;
+            row.total = total;
+        }
+    }
+    return true;
+}
+
+/* Runs the combination of row in a process of its own (self --run), and fills the times
+and memory of row. Returns FALSE if the process failed. */
+static bool measure( const string& self, ScalingRow& row ) {
+    ostringstream command;
+    command << "\"" << self << "\" --run " << row.threads << " " << row.mutN << " " << row.etaaN << " "
+        << row.angles << " " << row.photons;
+    FILE* child = popen( command.str().c_str(), "r" );
+    if ( !child ) {
+        cerr << "Error: could not run " << self << " (in benchScaling.cpp)." << endl;
+        return false;
+    }
+    char buffer[256];
+    string last;
+    while ( fgets( buffer, sizeof( buffer ), child ) ) {
+        last = buffer;
+    }
+    istringstream in( last );
+    in >> row.transport >> row.total >> row.peakMB;
+    if ( ( pclose( child ) != 0 ) || in.fail() ) {
+        cerr << "Error: the run of " << row.threads << " threads, " << row.mutN << "x" << row.etaaN << ", "
+            << row.angles << " angles and " << row.photons << " photons failed (in benchScaling.cpp)." << endl;
+        return false;
+    }
+
+    /* The tallies of the run: the ARS, its starting copy and the tally of each batch with its
+    starting copy, and the weight matrix of each thread */
+    double tally = 2.0 * ( row.threads + 1 ) * row.mutN * row.etaaN * 2 * row.angles +
+        row.threads * row.mutN * row.etaaN;
+    row.tallyMB = tally * sizeof( double ) / ( 1024.0 * 1024.0 );
+    return true;
+}
+
+/* Prints row as one line of the table */
+static void print( const ScalingRow& row ) {
+    double rate = row.photons / row.transport;
+    cout << left << setw( 8 ) << row.mode << right << setw( 8 ) << row.threads << setw( 8 )
+        << to_string( row.mutN ) + "x" + to_string( row.etaaN ) << setw( 8 ) << row.angles << setw( 10 )
+        << row.photons << setw( 12 ) << row.transport << setw( 12 ) << rate << setw( 12 ) << rate / row.threads
+        << setw( 12 ) << row.efficiency << setw( 10 ) << row.tallyMB << setw( 10 ) << row.peakMB << endl;
+}
+
+/* Writes rows to path as JSON. Returns FALSE if the file did not open. */
+static bool writeJson( const string& path, const vector<ScalingRow>& rows ) {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from benchScaling.cpp)." << endl;
+        return false;
+    }
+    saveData << "{" << endl << "  \"seed\": " << SEED << "," << endl << "  \"repeats\": " << REPEATS << ","
+        << endl << "  \"time\": " << time( NULL ) << "," << endl << "  \"processors\": " << omp_get_num_procs()
+        << "," << endl << "  \"compiler\": \"" << __VERSION__ << "\"," << endl << "  \"runs\": [";
+    for ( unsigned int k = 0; k < rows.size(); k++ ) {
+        const ScalingRow& r = rows.at(k);
+        double rate = r.photons / r.transport;
+        saveData << ( k ? "," : "" ) << endl << "    {\"mode\": \"" << r.mode << "\", \"threads\": " << r.threads
+            << ", \"mutN\": " << r.mutN << ", \"etaaN\": " << r.etaaN << ", \"angles\": " << r.angles
+            << ", \"photons\": " << r.photons << ", \"transportSeconds\": " << r.transport
+            << ", \"totalSeconds\": " << r.total << ", \"photonsPerSecond\": " << rate
+            << ", \"photonsPerSecondPerThread\": " << rate / r.threads << ", \"efficiency\": " << r.efficiency
+            << ", \"tallyMB\": " << r.tallyMB << ", \"peakRssMB\": " << r.peakMB << "}";
+    }
+    saveData << endl << "  ]" << endl << "}" << endl;
+    return true;
+}
+
+int main( int argc, char* argv[] ) {
+
+    /* One combination, in the process that measure started for it */
+    if ( ( argc == 7 ) && ( string( argv[1] ) == "--run" ) ) {
+        ScalingRow row;
+        row.threads = atoi( argv[2] );
+        row.mutN = atoi( argv[3] );
+        row.etaaN = atoi( argv[4] );
+        row.angles = atoi( argv[5] );
+        row.photons = atoi( argv[6] );
+        Solver solver;
+        if ( !solver.init( row.threads, SEED ) || !run( solver, row ) ) {
+            return 1;
+        }
+        cout << setprecision( 10 ) << row.transport << " " << row.total << " " << peakMB() << endl;
+        return 0;
+    }
+
+    string self = argv[0];
+    int maxThreads = ( argc > 1 ) ? atoi( argv[1] ) : 0;
+    string path = ( argc > 2 ) ? argv[2] : "bench/scaling.json";
+    if ( maxThreads <= 0 ) {
+        maxThreads = omp_get_num_procs();
+    }
+
+    vector<unsigned int> threadList;
+    for ( int p = 1; p < maxThreads; p *= 2 ) {
+        threadList.push_back( p );
+    }
+    threadList.push_back( maxThreads );
+
+    unsigned int gridList[][2] = { { 5, 5 }, { 17, 15 }, { 41, 41 } };
+    unsigned int angleList[] = { 36, 180 };
+    unsigned int photonList[] = { 20000, 80000 };
+    unsigned int numGrids = 3, numAngles = 2, numPhotons = 2;
+
+    cout << left << setw( 8 ) << "mode" << right << setw( 8 ) << "threads" << setw( 8 ) << "grid" << setw( 8 )
+        << "angles" << setw( 10 ) << "photons" << setw( 12 ) << "transport s" << setw( 12 ) << "photons/s"
+        << setw( 12 ) << "per thread" << setw( 12 ) << "efficiency" << setw( 10 ) << "tally MB" << setw( 10 )
+        << "peak MB" << endl;
+    cout << setprecision( 4 );
+
+    /* Times on one thread of each combination, which the efficiencies are relative to */
+    vector<double> strongBase( numGrids * numAngles * numPhotons, 0 );
+    double weakBase = 0;
+    vector<ScalingRow> rows;
+
+    for ( unsigned int t = 0; t < threadList.size(); t++ ) {
+        for ( unsigned int g = 0; g < numGrids; g++ ) {
+        for ( unsigned int a = 0; a < numAngles; a++ ) {
+        for ( unsigned int p = 0; p < numPhotons; p++ ) {
+            ScalingRow row;
+            row.mode = "strong";
+            row.threads = threadList.at(t);
+            row.mutN = gridList[g][0];
+            row.etaaN = gridList[g][1];
+            row.angles = angleList[a];
+            row.photons = photonList[p];
+            if ( !measure( self, row ) ) {
+                return 1;
+            }
+            double& base = strongBase.at( ( g * numAngles + a ) * numPhotons + p );
+            if ( t == 0 ) {
+                base = row.transport;
+            }
+            row.efficiency = base / ( row.threads * row.transport );
+            rows.push_back( row );
+            print( row );
+        }
+        }
+        }
+
+        /* The same photons on every thread, over the example grid */
+        ScalingRow row;
+        row.mode = "weak";
+        row.threads = threadList.at(t);
+        row.mutN = 17;
+        row.etaaN = 15;
+        row.angles = 36;
+        row.photons = WEAK_PHOTONS * row.threads;
+        if ( !measure( self, row ) ) {
+            return 1;
+        }
+        if ( t == 0 ) {
+            weakBase = row.transport;
+        }
+        row.efficiency = weakBase / row.transport;
+        rows.push_back( row );
+        print( row );
+    }
+
+    return writeJson( path, rows ) ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+#include "solver.h"
+#include "fileToVec.h"
+#include "gridVec.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* CheckEquivalence tests whether a changed build (a candidate, e.g. a faster propagate,
+scatter, medInterface or Weight update) simulates the same physics as a reference build.
+Such a change changes the random sequence, so the results can only agree within their
+Monte Carlo error. "run" measures one build and saves the results with their standard
+errors to a file, and "compare" tests two such files against each other:
+
+1. ARS: the forward model at the center of the example grid is run in BATCHES independent
+batches of photons / BATCHES photons each, over NUM_ANGLES angles. The mean and the
+standard error of the mean of every bin come from the spread of the batches. The test
+statistic is chi-square = sum over bins of (a - b)^2 / (sa^2 + sb^2), with one degree of
+freedom per bin, and the test fails if its p-value is below P_MIN (Wilson-Hilferty
+approximation of the chi-square distribution).
+
+2. R and T: the diffuse reflectance and transmittance per photon, from the bins of each
+batch with theta above and below 90 degrees (NUM_ANGLES is odd, so no bin straddles
+90 degrees). The test fails if the z-score of either difference is above Z_MAX.
+
+3. MLE: the inverse algorithm is run FITS times on the example input (inputExample.txt,
+expExample.txt) with FIT_PARTICLES starting particles and FIT_ITER iterations. The test
+fails if the z-score of the difference of the mean eta_a or mu_t is above Z_MAX.
+
+Compare prints every statistic with its threshold, and returns 0 if all tests pass and 1
+otherwise. The two runs should use different seeds, so that they are independent. Built
+and run with make equivalence. */
+
+/* Variables:
+    BATCHES, NUM_ANGLES, PHOTONS: Batches and angles of the ARS, and default photons in all
+    FITS, FIT_PARTICLES, FIT_ITER: Runs of the inverse algorithm and their size
+    P_MIN, Z_MAX: Thresholds of the tests
+    Measurement: The means and standard errors of the ARS bins, R, T, eta_a and mu_t
+*/
+
+/******************************************************************************/
+
+static const unsigned int BATCHES = 20;
+static const unsigned int NUM_ANGLES = 37;
+static const unsigned int PHOTONS = 400000;
+static const unsigned int FITS = 6;
+static const unsigned int FIT_PARTICLES = 20000;
+static const unsigned int FIT_ITER = 3;
+static const double P_MIN = 0.001;
+static const double Z_MAX = 4;
+
+struct Measurement {
+    unsigned int photons;
+    vector<double> ars, arsErr;
+    double R, RErr, T, TErr, etaa, etaaErr, mut, mutErr;
+};
+
+/* Mean and standard error of the mean of samples */
+static void meanErr( const vector<double>& samples, double& mean, double& err ) {
+    double n = samples.size(), sum = 0, sumSq = 0;
+    for ( unsigned int k = 0; k < samples.size(); k++ ) {
+        sum += samples.at(k);
+    }
+    mean = sum / n;
+    for ( unsigned int k = 0; k < samples.size(); k++ ) {
+        sumSq += ( samples.at(k) - mean ) * ( samples.at(k) - mean );
+    }
+    err = ( n > 1 ) ? sqrt( sumSq / ( n - 1 ) / n ) : 0;
+}
+
+/* Weight per photon that escaped into the solid angle of each bin of a fixed ARS curve,
+undoing the division by the solid angle in fixARS. Bin k of the curve before its flip
+covers the polar angles (k - 1/2) to (k + 1/2) times 180/N degrees, and bin 0 only the
+upper half. */
+static void escapedWeight( const vector<double>& ars, double& R, double& T ) {
+    const double PI = 3.14159265358979323846;
+    unsigned int N = ars.size();
+    R = 0;
+    T = 0;
+    for ( unsigned int k = 0; k < N; k++ ) {
+        double lower = ( k > 0 ) ? cos( ( k - 0.5 ) * PI / N ) : 1;
+        double w = ars.at( N-1-k ) * 2 * PI * ( lower - cos( ( k + 0.5 ) * PI / N ) );
+        if ( 2*k + 1 <= N ) {
+            T += w;
+        }
+        else {
+            R += w;
+        }
+    }
+}
+
+/* Measures the ARS, R, T and MLE of this build with photons photons, on the threads of
+solver, into m. Returns FALSE if there is an error. */
+static bool measure( Solver& solver, unsigned int photons, Measurement& m ) {
+    InverseSetup setup;
+    setup.layerVec.assign( 1, Layer( 1.493, 2.6 * ( 1 - 0.008 ), 2.6 * 0.008, 0.621, 6.10 ) );
+    setup.mutVec.assign( 1, vector<double>( 1, 2.6 ) );
+    setup.etaaVec.assign( 1, vector<double>( 1, 0.008 ) );
+    setup.expData.assign( NUM_ANGLES, 0 );
+    setup.numParticles = photons / BATCHES;
+    setup.radius = 669.8;
+    m.photons = setup.numParticles * BATCHES;
+
+    /* The ARS, R and T of each batch */
+    vector<vector<double> > bins( NUM_ANGLES );
+    vector<double> Rs, Ts;
+    for ( unsigned int b = 0; b < BATCHES; b++ ) {
+        InverseSetup batch = setup;
+        InverseResult result;
+        if ( !solver.forward( batch, result ) ) {
+            return false;
+        }
+        const vector<double>& curve = result.ars.at(0).at(0);
+        for ( unsigned int k = 0; k < NUM_ANGLES; k++ ) {
+            bins.at(k).push_back( curve.at(k) );
+        }
+        double R, T;
+        escapedWeight( curve, R, T );
+        Rs.push_back( R );
+        Ts.push_back( T );
+    }
+    m.ars.assign( NUM_ANGLES, 0 );
+    m.arsErr.assign( NUM_ANGLES, 0 );
+    for ( unsigned int k = 0; k < NUM_ANGLES; k++ ) {
+        meanErr( bins.at(k), m.ars.at(k), m.arsErr.at(k) );
+    }
+    meanErr( Rs, m.R, m.RErr );
+    meanErr( Ts, m.T, m.TErr );
+
+    /* The fitted eta_a and mu_t of the example, FITS times. The progress output is dropped. */
+    InverseSetup fit;
+    fit.layerVec.assign( 1, Layer( 1.493, 1, 0, 0.621, 6.10 ) );
+    fit.mutVec.assign( 1, gridVec( 1.0, 4.2, 17 ) );
+    fit.etaaVec.assign( 1, gridVec( 0.001, 0.015, 15 ) );
+    fileToVec( fit.expData, "dataIn/expExample.txt" );
+    if ( fit.expData.empty() ) {
+        cerr << "Error: dataIn/expExample.txt is empty or missing (in checkEquivalence.cpp)." << endl;
+        return false;
+    }
+    fit.numParticles = FIT_PARTICLES;
+    fit.numIter = FIT_ITER;
+    fit.radius = 669.8;
+
+    vector<double> etaas, muts;
+    ostringstream quiet;
+    streambuf* coutBuf = cout.rdbuf( quiet.rdbuf() );
+    bool done = true;
+    for ( unsigned int r = 0; r < FITS && done; r++ ) {
+        InverseSetup trial = fit;
+        InverseResult result;
+        done = solver.inverse( trial, result );
+        if ( done ) {
+            etaas.push_back( result.paramOut.at(0).at(3) );
+            muts.push_back( result.paramOut.at(0).at(4) );
+        }
+    }
+    cout.rdbuf( coutBuf );
+    if ( !done ) {
+        return false;
+    }
+    meanErr( etaas, m.etaa, m.etaaErr );
+    meanErr( muts, m.mut, m.mutErr );
+    return true;
+}
+
+/* Writes m to path. Returns FALSE if the file did not open. */
+static bool save( const string& path, const Measurement& m ) {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from checkEquivalence.cpp)." << endl;
+        return false;
+    }
+    saveData << setprecision( 17 ) << "MCSLEQUIV 1" << endl << "photons " << m.photons << endl
+        << "angles " << m.ars.size() << endl;
+    for ( unsigned int k = 0; k < m.ars.size(); k++ ) {
+        saveData << "ars " << m.ars.at(k) << " " << m.arsErr.at(k) << endl;
+    }
+    saveData << "R " << m.R << " " << m.RErr << endl << "T " << m.T << " " << m.TErr << endl
+        << "etaa " << m.etaa << " " << m.etaaErr << endl << "mut " << m.mut << " " << m.mutErr << endl;
+    return true;
+}
+
+/* Reads m from path. Returns FALSE if the file did not open or is not a measurement. */
+static bool load( const string& path, Measurement& m ) {
+    ifstream readData( path.c_str() );
+    string key;
+    unsigned int version = 0, angles = 0;
+    readData >> key >> version;
+    if ( !readData || ( key != "MCSLEQUIV" ) || ( version != 1 ) ) {
+        cerr << "Error: " << path << " is not a measurement of checkEquivalence (in checkEquivalence.cpp)." << endl;
+        return false;
+    }
+    readData >> key >> m.photons >> key >> angles;
+    m.ars.assign( angles, 0 );
+    m.arsErr.assign( angles, 0 );
+    for ( unsigned int k = 0; k < angles; k++ ) {
+        readData >> key >> m.ars.at(k) >> m.arsErr.at(k);
+    }
+    readData >> key >> m.R >> m.RErr >> key >> m.T >> m.TErr >> key >> m.etaa >> m.etaaErr >> key >> m.mut >> m.mutErr;
+    if ( !readData ) {
+        cerr << "Error: could not read " << path << " (in checkEquivalence.cpp)." << endl;
+        return false;
+    }
+    return true;
+}
+
+/* Prints the z-score of the difference of a and b, and returns whether it is within Z_MAX */
+static bool zTest( const string& name, double a, double aErr, double b, double bErr ) {
+    double err = sqrt( aErr*aErr + bErr*bErr );
+    double z = ( err > 0 ) ? ( b - a ) / err : ( ( a == b ) ? 0 : HUGE_VAL );
+    bool pass = ( fabs( z ) <= Z_MAX );
+    cout << setw( 6 ) << name << ": reference " << a << " +- " << aErr << ", candidate " << b << " +- " << bErr
+        << ", z = " << z << " (|z| <= " << Z_MAX << ") " << ( pass ? "pass" : "FAIL" ) << endl;
+    return pass;
+}
+
+/* Tests candidate against reference. Returns whether all tests pass. */
+static bool compare( const Measurement& ref, const Measurement& cand ) {
+    if ( ref.ars.size() != cand.ars.size() ) {
+        cerr << "Error: the measurements have different angles (in checkEquivalence.cpp)." << endl;
+        return false;
+    }
+
+    /* Chi-square of the bins with any spread, and its upper tail p-value */
+    double chi2 = 0, zMax = 0;
+    unsigned int dof = 0, kMax = 0;
+    for ( unsigned int k = 0; k < ref.ars.size(); k++ ) {
+        double var = ref.arsErr.at(k) * ref.arsErr.at(k) + cand.arsErr.at(k) * cand.arsErr.at(k);
+        if ( var <= 0 ) {
+            continue;
+        }
+        double d = cand.ars.at(k) - ref.ars.at(k);
+        chi2 += d * d / var;
+        dof++;
+        if ( fabs( d ) / sqrt( var ) > zMax ) {
+            zMax = fabs( d ) / sqrt( var );
+            kMax = k;
+        }
+    }
+    double wh = ( dof > 0 ) ? ( pow( chi2 / dof, 1.0/3 ) - ( 1 - 2.0 / ( 9 * dof ) ) ) / sqrt( 2.0 / ( 9 * dof ) ) : 0;
+    double p = 0.5 * erfc( wh / sqrt( 2.0 ) );
+    bool pass = ( dof > 0 ) && ( p >= P_MIN );
+
+    cout << setprecision( 4 ) << "Photons: reference " << ref.photons << ", candidate " << cand.photons << endl;
+    cout << "   ARS: chi-square " << chi2 << " over " << dof << " bins, p = " << p << " (p >= " << P_MIN << ") "
+        << ( pass ? "pass" : "FAIL" ) << "; largest |z| " << zMax << " in bin " << kMax << endl;
+    pass = zTest( "R", ref.R, ref.RErr, cand.R, cand.RErr ) && pass;
+    pass = zTest( "T", ref.T, ref.TErr, cand.T, cand.TErr ) && pass;
+    pass = zTest( "eta_a", ref.etaa, ref.etaaErr, cand.etaa, cand.etaaErr ) && pass;
+    pass = zTest( "mu_t", ref.mut, ref.mutErr, cand.mut, cand.mutErr ) && pass;
+    cout << ( pass ? "Equivalent" : "NOT equivalent" ) << endl;
+    return pass;
+}
+
+int main( int argc, char* argv[] ) {
+    string mode = ( argc > 1 ) ? argv[1] : "";
+
+    if ( ( mode == "run" ) && ( argc >= 4 ) ) {
+        unsigned int photons = ( argc > 4 ) ? atoi( argv[4] ) : PHOTONS;
+        Solver solver;
+        Measurement m;
+        if ( !solver.init( omp_get_num_procs(), atoi( argv[3] ) ) || !measure( solver, photons, m ) ||
+            !save( argv[2], m ) ) {
+            return 1;
+        }
+        cout << "Measured " << m.photons << " photons and " << FITS << " fits into " << argv[2] << endl;
+        return 0;
+    }
+
+    if ( ( mode == "compare" ) && ( argc == 4 ) ) {
+        Measurement ref, cand;
+        if ( !load( argv[2], ref ) || !load( argv[3], cand ) ) {
+            return 1;
+        }
+        return compare( ref, cand ) ? 0 : 1;
+    }
+
+    cerr << "Usage: checkEquivalence.x run file seed [photons]" << endl
+        << "       checkEquivalence.x compare reference candidate" << endl;
+    return 1;
+}
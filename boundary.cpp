@@ -14,14 +14,25 @@ in main. Otherwise it returns 2 to propagate again. */
 int boundary( Particle& par, Layer& airLayer, vector<Layer>& layerVec ) {
 
         double kz = par.dir.at(2);
+        COUNT_EVENT( par.counters.boundaryHits++ );
 
         /* Let particle escape medium entirely. If the particle wants to move beneath the
         first layer, or above the last layer, it could escape.  */
         if ( ( ( par.lay.getLayerNum() == 0 ) && ( kz < 0 ) ) ||
         ( ( par.lay.getLayerNum() == layerVec.size() - 1 ) && ( kz > 0 ) ) ) {
 
+            double n0 = par.lay.getN();
+            bool escaped = medInterface( par, airLayer, par.sprngptr );
+
+            /* Reweight the scanned indices of refraction by the sampled decision */
+            if ( !par.weight.weightN.empty() ) {
+                par.weight.updateWeightN( kz, n0, airLayer.getN(), !escaped );
+            }
+
             /* Return 4 if the particle has escaped medium */
-            if ( medInterface( par, airLayer, par.sprngptr ) ) {
+            if ( escaped ) {
+                COUNT_EVENT( ( ( kz < 0 ) ? par.counters.escapesReflected : par.counters.escapesTransmitted )++ );
+                COUNT_EVENT( ( ( kz < 0 ) ? par.counters.reflected : par.counters.transmitted ) += par.weight.wScale );
 
                 /* Call detect in main. */
                 return 4;
@@ -30,13 +41,16 @@ int boundary( Particle& par, Layer& airLayer, vector<Layer>& layerVec ) {
 
         /* Case where particle moves from one material to another in medium */
         else {
+            bool crossed;
             if ( kz > 0 ) {
-                medInterface( par, layerVec.at( par.lay.getLayerNum() + 1 ), par.sprngptr );
+                crossed = medInterface( par, layerVec.at( par.lay.getLayerNum() + 1 ), par.sprngptr );
             }
 
             else {
-                medInterface( par, layerVec.at( par.lay.getLayerNum() - 1 ), par.sprngptr );
+                crossed = medInterface( par, layerVec.at( par.lay.getLayerNum() - 1 ), par.sprngptr );
             }
+            COUNT_EVENT( par.counters.layerCrossings += crossed );
+            (void) crossed;
         }
 
         /* Call propagate in main */
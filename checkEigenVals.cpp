@@ -5,7 +5,7 @@
 /* CheckEigenVals calculates the Hessian eigenvalues to ensure that we have
 found a maximum on the likelihood surface, not a saddle point or a minimum.
 Both eigenvalues should be negative. CheckEigenVals returns FALSE if there
-is not a maximum and TRUE if there is. */
+is not a maximum and TRUE if there is. The reason is only printed if verbose is TRUE. */
 
 /* Variables:
     D: Determinate of Hessian
@@ -15,13 +15,15 @@ is not a maximum and TRUE if there is. */
 
 /******************************************************************************/
 
-bool checkEigenVals( const vector<double>& hessian ) {
+bool checkEigenVals( const vector<double>& hessian, bool verbose ) {
     double D = hessian.at(0)*hessian.at(2) - hessian.at(1)*hessian.at(1);
     double T = hessian.at(0) + hessian.at(2);
 
     /* This condition will lead to a negative under a square root when finding the eigenvalues. */
     if ( T*T/4 < D ) {
-        cerr << "Error: unreal eigenvalues (from checkEigenVals.cpp)" << endl;
+        if ( verbose ) {
+            cerr << "Error: unreal eigenvalues (from checkEigenVals.cpp)" << endl;
+        }
         return false;
     }
 
@@ -32,18 +34,24 @@ bool checkEigenVals( const vector<double>& hessian ) {
     of each, or both be positive. */
     if ( lambda1 >= 0 ) {
         if ( lambda2 < 0 ) {
-            cerr << "Error: saddle point (from checkEigenVals.cpp)" << endl;
+            if ( verbose ) {
+                cerr << "Error: saddle point (from checkEigenVals.cpp)" << endl;
+            }
             return false;
         }
         else {
-            cerr << "Error: minimum (from checkEigenVals.cpp)" << endl;
+            if ( verbose ) {
+                cerr << "Error: minimum (from checkEigenVals.cpp)" << endl;
+            }
             return false;
         }
     }
 
     else {
         if ( lambda2 > 0 ) {
-            cerr << "Error: saddle point (from checkEigenVals.cpp)" << endl;
+            if ( verbose ) {
+                cerr << "Error: saddle point (from checkEigenVals.cpp)" << endl;
+            }
             return false;
         }
         else return true;
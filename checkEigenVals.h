@@ -6,4 +6,4 @@ using namespace std;
 
 #pragma once
 
-bool checkEigenVals( const vector<double>& );
+bool checkEigenVals( const vector<double>&, bool );
@@ -0,0 +1,217 @@
+#include "checkpoint.h"
+
+/* Checkpoint holds the state of an inverse run between two slices of a forward run, so
+that a run that is stopped can go on from there with the resume option and end with the
+same result, to the last bit. Write saves the state and the packed random number stream
+of every thread to a file, by writing a temporary file next to it and renaming it over
+the old one, so that a run stopped in the middle of a write leaves the last checkpoint
+whole. Read loads a checkpoint and replaces the streams with the saved ones. The file is
+in the byte order of the machine that wrote it. */
+
+/* Members:
+    shape: Sizes of the run that the checkpoint fits (threads, batches, layers, angles,
+        mut and etaa combinations, rounds, slices), checked when it is read
+    iter, round, slice: The iteration, round and slice to go on with
+    numParticles, numDone: Particles of the iteration, and particles sent in it so far
+    settled, lastBox: The state of the settle check of the sequential option
+    elapsed: Wall-clock seconds of the run so far, for the time budget
+    mutVec, etaaVec: The search grid of each layer
+    paramOut: The contour parameters of each layer
+    arsProc: The ARS tally of each batch so far
+    arsNProc: The tallies of each thread reweighted to the n grid, in the last iteration
+*/
+
+/******************************************************************************/
+
+static const char checkpointMagic[8] = { 'M', 'C', 'S', 'L', 'C', 'K', 'P', '\0' };
+static const uint32_t checkpointVersion = 1;
+
+/* Binary writing and reading of numbers and of nested vectors of them */
+template <class T> static void put( ostream& out, const T& value ) {
+    out.write( (const char*) &value, sizeof( T ) );
+}
+
+template <class T> static void put( ostream& out, const vector<T>& values ) {
+    put( out, (uint64_t) values.size() );
+    for ( size_t i = 0; i < values.size(); i++ ) {
+        put( out, values[i] );
+    }
+}
+
+template <class T> static void get( istream& in, T& value ) {
+    in.read( (char*) &value, sizeof( T ) );
+}
+
+template <class T> static void get( istream& in, vector<T>& values ) {
+    uint64_t size = 0;
+    get( in, size );
+    if ( !in || size > ( 1ULL << 32 ) ) {
+        in.setstate( ios::failbit );
+        return;
+    }
+    values.assign( size, T() );
+    for ( size_t i = 0; i < values.size() && in; i++ ) {
+        get( in, values[i] );
+    }
+}
+
+Checkpoint::Checkpoint() {
+    shape.clear();
+    iter = 0;
+    round = 0;
+    slice = 0;
+    numParticles = 0;
+    numDone = 0;
+    settled = 0;
+    elapsed = 0;
+    lastBox.clear();
+    mutVec.clear();
+    etaaVec.clear();
+    paramOut.clear();
+    arsProc.clear();
+    arsNProc.clear();
+}
+
+/* Writes the checkpoint and the streams of numProc threads to path. Returns FALSE if the
+file could not be written, in which case the last checkpoint is left as it was. */
+#ifdef SPRNGFIVE
+bool Checkpoint::write( const string& path, Sprng** streams, unsigned int numProc ) const {
+#else
+bool Checkpoint::write( const string& path, int** streams, unsigned int numProc ) const {
+#endif
+    string tmpPath = path + ".tmp";
+    ofstream out( tmpPath.c_str(), ios::binary | ios::trunc );
+    if ( !out.is_open() ) {
+        cerr << "Error: could not write checkpoint " << tmpPath << " (in checkpoint.cpp)." << endl;
+        return false;
+    }
+
+    out.write( checkpointMagic, sizeof( checkpointMagic ) );
+    put( out, checkpointVersion );
+    put( out, shape );
+    put( out, iter );
+    put( out, round );
+    put( out, slice );
+    put( out, numParticles );
+    put( out, numDone );
+    put( out, settled );
+    put( out, elapsed );
+    put( out, lastBox );
+    put( out, mutVec );
+    put( out, etaaVec );
+    put( out, paramOut );
+    put( out, arsProc );
+    put( out, arsNProc );
+
+    /* The packed state of every stream */
+    for ( unsigned int n = 0; n < numProc; n++ ) {
+        char* buffer = NULL;
+#ifdef SPRNGFIVE
+        int size = streams[n]->pack_sprng( &buffer );
+#else
+        int size = pack_sprng( streams[n], &buffer );
+#endif
+        put( out, (int32_t) size );
+        out.write( buffer, size );
+        free( buffer );
+    }
+    out.close();
+    if ( out.fail() ) {
+        cerr << "Error: could not write checkpoint " << tmpPath << " (in checkpoint.cpp)." << endl;
+        return false;
+    }
+
+    /* Make the new file durable before it replaces the old one */
+#ifndef _WIN32
+    int fd = open( tmpPath.c_str(), O_RDONLY );
+    if ( fd >= 0 ) {
+        fsync( fd );
+        close( fd );
+    }
+#else
+    remove( path.c_str() );
+#endif
+    if ( rename( tmpPath.c_str(), path.c_str() ) != 0 ) {
+        cerr << "Error: could not replace checkpoint " << path << " (in checkpoint.cpp)." << endl;
+        return false;
+    }
+    return true;
+}
+
+/* Reads the checkpoint at path, and replaces the streams of numProc threads with the saved
+ones. Returns FALSE if the file is missing or damaged, or was written by a run with a
+different shape (the caller sets shape before reading). */
+#ifdef SPRNGFIVE
+bool Checkpoint::read( const string& path, Sprng** streams, unsigned int numProc ) {
+#else
+bool Checkpoint::read( const string& path, int** streams, unsigned int numProc ) {
+#endif
+    ifstream in( path.c_str(), ios::binary );
+    if ( !in.is_open() ) {
+        cerr << "Error: checkpoint " << path << " did not open (in checkpoint.cpp)." << endl;
+        return false;
+    }
+
+    char magic[8];
+    uint32_t version = 0;
+    vector<unsigned int> savedShape;
+    in.read( magic, sizeof( magic ) );
+    get( in, version );
+    get( in, savedShape );
+    if ( !in || ( string( magic, 7 ) != string( checkpointMagic, 7 ) ) || ( version != checkpointVersion ) ) {
+        cerr << "Error: " << path << " is not a checkpoint (in checkpoint.cpp)." << endl;
+        return false;
+    }
+    if ( savedShape != shape ) {
+        cerr << "Error: checkpoint " << path << " is from a run with other settings or processors "
+            << "(in checkpoint.cpp)." << endl;
+        return false;
+    }
+
+    get( in, iter );
+    get( in, round );
+    get( in, slice );
+    get( in, numParticles );
+    get( in, numDone );
+    get( in, settled );
+    get( in, elapsed );
+    get( in, lastBox );
+    get( in, mutVec );
+    get( in, etaaVec );
+    get( in, paramOut );
+    get( in, arsProc );
+    get( in, arsNProc );
+
+    /* Unpack every stream before any of the old ones is replaced */
+    vector<vector<char> > packed( numProc );
+    for ( unsigned int n = 0; n < numProc && in; n++ ) {
+        int32_t size = 0;
+        get( in, size );
+        if ( !in || size <= 0 ) {
+            in.setstate( ios::failbit );
+            break;
+        }
+        packed.at(n).assign( size, 0 );
+        in.read( packed.at(n).data(), size );
+    }
+    if ( !in ) {
+        cerr << "Error: checkpoint " << path << " is damaged (in checkpoint.cpp)." << endl;
+        return false;
+    }
+
+    for ( unsigned int n = 0; n < numProc; n++ ) {
+#ifdef SPRNGFIVE
+        streams[n]->unpack_sprng( packed.at(n).data() );
+#else
+        int* stream = unpack_sprng( packed.at(n).data() );
+        if ( !stream ) {
+            cerr << "Error: could not unpack stream " << n << " of checkpoint " << path
+                << " (in checkpoint.cpp)." << endl;
+            return false;
+        }
+        free_sprng( streams[n] );
+        streams[n] = stream;
+#endif
+    }
+    return true;
+}
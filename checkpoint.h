@@ -0,0 +1,47 @@
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <stdint.h>
+
+#ifdef SPRNGFIVE
+#include "sprng_cpp.h"
+#else
+#include "sprng.h"
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#pragma once
+
+class Checkpoint {
+    public:
+    Checkpoint();
+    #ifdef SPRNGFIVE
+    bool write( const string&, Sprng**, unsigned int ) const;
+    bool read( const string&, Sprng**, unsigned int );
+    #else
+    bool write( const string&, int**, unsigned int ) const;
+    bool read( const string&, int**, unsigned int );
+    #endif
+    vector<unsigned int> shape;
+    unsigned int iter;
+    unsigned int round;
+    unsigned int slice;
+    unsigned int numParticles;
+    unsigned int numDone;
+    unsigned int settled;
+    double elapsed;
+    vector<int> lastBox;
+    vector<vector<double> > mutVec, etaaVec;
+    vector<vector<double> > paramOut;
+    vector<vector<vector<vector<double> > > > arsProc;
+    vector<vector<vector<vector<vector<double> > > > > arsNProc;
+};
@@ -6,7 +6,9 @@
 It is called by updateInterval in the last iteration of updating the search box.
 It fits the 9 points around the discrete likelihood maximum to a paraboloid and
 solves for the discrete maximum. Contour will return FALSE if there is no true
-maximum (due to a minimum or saddle point) and TRUE if there is a maximum. */
+maximum (due to a minimum or saddle point) and TRUE if there is a maximum. The MLE is
+printed to progress. If progress is NULL, as for the early contours of an adaptive run, nothing is
+printed. */
 
 /* Variables:
     dmut, detaa: The difference between each entry in the mut and etaa vectors
@@ -20,7 +22,7 @@ maximum (due to a minimum or saddle point) and TRUE if there is a maximum. */
 /******************************************************************************/
 
 bool contour( const vector<vector<double> >& likGrid, vector<double>& storeParab,
-    vector<double>& etaaVec, vector<double>& mutVec, int i0, int j0 ) {
+    vector<double>& etaaVec, vector<double>& mutVec, int i0, int j0, ostream* progress ) {
 
     /* Initialize variables and vectors */
     double dmut, detaa;
@@ -42,7 +44,7 @@ bool contour( const vector<vector<double> >& likGrid, vector<double>& storeParab
     storeParab.at(2) = coeffs.at(5);
 
     /* Check if there is really a maximum, not a saddle point or a minimum */
-    if ( !checkEigenVals( storeParab ) ) {
+    if ( !checkEigenVals( storeParab, progress != NULL ) ) {
         return false;
     }
 
@@ -52,8 +54,10 @@ bool contour( const vector<vector<double> >& likGrid, vector<double>& storeParab
     mutMle += mutVec.front() + i0*dmut;
     storeParab.at(3) = etaaMle;
     storeParab.at(4) = mutMle;
-    cout << "eta_a = " << etaaMle << endl;
-    cout << "mu_t = " << mutMle << endl << endl;
+    if ( progress ) {
+        *progress << "eta_a = " << etaaMle << endl;
+        *progress << "mu_t = " << mutMle << endl << endl;
+    }
     return true;
 }
 
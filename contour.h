@@ -12,4 +12,4 @@ using namespace std;
 #pragma once
 
 bool contour( const vector<vector<double> >&, vector<double>&,
-    vector<double>&, vector<double>&, int, int );
+    vector<double>&, vector<double>&, int, int, ostream* );
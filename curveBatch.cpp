@@ -0,0 +1,210 @@
+#include "curveBatch.h"
+
+/* CurveBatch fits many experimental ARS curves from the same forward runs, for samples
+that share n, g and t. The forward run does not depend on the experimental data, so each
+iteration simulates the particles once, on a grid that covers the search regions of all
+curves, and update scores every curve against the same ARS. Each curve keeps its own
+search region and gets its own contour on the last iteration. The next grid is the
+smallest one that covers all of the regions, with the same number of points, so curves
+that are far apart share a coarser grid. A curve whose discrete maximum falls on the edge
+of the grid is dropped from the batch and reported as failed. */
+
+/* Members:
+    curves: Experimental ARS of each curve
+    names: Name of each curve, its file name or column number
+    param: Contour parameters of each curve, in the form of contour
+    status: Result of each curve, "ok" or why it failed
+    active: FALSE for a curve that has been dropped
+*/
+
+/******************************************************************************/
+
+CurveBatch::CurveBatch() {
+    curves.clear();
+    names.clear();
+    param.clear();
+    status.clear();
+    active.clear();
+}
+
+/* Reads the curves from path. If path is a directory, every file in it is one curve in
+the format of exp.txt, in order of file name. Otherwise, every column of the file is one
+curve, with one row per angle. Returns FALSE if there are no curves or they do not all
+have the same length. */
+bool CurveBatch::read( const string& path ) {
+    struct stat info;
+    if ( stat( path.c_str(), &info ) != 0 ) {
+        cerr << "Error: could not find batch " << path << " (in curveBatch.cpp)." << endl;
+        return false;
+    }
+
+    if ( S_ISDIR( info.st_mode ) ) {
+        DIR *dir = opendir( path.c_str() );
+        struct dirent *entry;
+        while ( dir && ( entry = readdir( dir ) ) ) {
+            string fileName = path + "/" + entry->d_name;
+            if ( ( stat( fileName.c_str(), &info ) == 0 ) && S_ISREG( info.st_mode ) ) {
+                names.push_back( entry->d_name );
+            }
+        }
+        if ( dir ) {
+            closedir( dir );
+        }
+
+        sort( names.begin(), names.end() );
+        curves.assign( names.size(), vector<double>() );
+        for ( unsigned int c = 0; c < names.size(); c++ ) {
+            fileToVec( curves.at(c), path + "/" + names.at(c) );
+        }
+    }
+
+    else {
+        ifstream inputFile( path.c_str() );
+        string line;
+        while ( getline( inputFile, line ) ) {
+            stringstream row( line );
+            double val;
+            unsigned int c = 0;
+            while ( row >> val ) {
+                if ( c == curves.size() ) {
+                    curves.push_back( vector<double>() );
+                    names.push_back( "column " + to_string( c+1 ) );
+                }
+                curves.at(c).push_back( val );
+                c++;
+            }
+        }
+    }
+
+    if ( curves.size() == 0 ) {
+        cerr << "Error: no curves in batch " << path << " (in curveBatch.cpp)." << endl;
+        return false;
+    }
+
+    for ( unsigned int c = 0; c < curves.size(); c++ ) {
+        if ( ( curves.at(c).size() == 0 ) || ( curves.at(c).size() != curves.at(0).size() ) ) {
+            cerr << "Error: curve " << names.at(c) << " does not have the length of the first "
+                << "curve (in curveBatch.cpp)." << endl;
+            return false;
+        }
+    }
+
+    param.assign( curves.size(), vector<double>( 5, 0 ) );
+    status.assign( curves.size(), "ok" );
+    active.assign( curves.size(), true );
+    return true;
+}
+
+/* Scores every active curve against the fixed ARS on the grid of mutVec and etaaVec, or
+against its reduced form if reduced has a basis (reducedBasis option). On
+the last iteration, it fits the contour of each curve. Otherwise, it finds the search
+region of each curve with findRegion, as updateInterval does, and sets mutVec and etaaVec
+to the grid that covers all of them, which it prints to progress. Returns FALSE if no curve is
+left. */
+bool CurveBatch::update( const vector<vector<vector<double> > >& ars, const ReducedArs& reduced,
+    vector<double>& mutVec, vector<double>& etaaVec, bool last, ostream& progress ) {
+
+    unsigned int mutSize = mutVec.size(), etaaSize = etaaVec.size();
+    double dmut = ( mutVec.back() - mutVec.front() ) / ( mutSize - 1 );
+    double detaa = ( etaaVec.back() - etaaVec.front() ) / ( etaaSize - 1 );
+    double mutLo = 0, mutHi = 0, etaaLo = 0, etaaHi = 0;
+    bool found = false;
+    vector<vector<double> > likGrid( mutSize, vector<double>( etaaSize, 0 ) );
+
+    for ( unsigned int c = 0; c < curves.size(); c++ ) {
+        int i0 = 0, j0 = 0, iMin, jMin;
+        int iMax = mutSize-1, jMax = etaaSize-1;
+        if ( !active.at(c) ) {
+            continue;
+        }
+
+        if ( reduced.rank > 0 ) {
+            if ( !reduced.score( likGrid, curves.at(c) ) ) {
+                return false;
+            }
+        }
+        else if ( !scoreParam( ars, likGrid, curves.at(c), mutSize, etaaSize ) ) {
+            return false;
+        }
+        subFromMax( likGrid, mutSize, etaaSize );
+
+        if ( !discMax( likGrid, i0, j0, mutSize, etaaSize, false ) ) {
+            active.at(c) = false;
+            status.at(c) = "maximum on edge of grid";
+            continue;
+        }
+
+        if ( last ) {
+            if ( !contour( likGrid, param.at(c), etaaVec, mutVec, i0, j0, NULL ) ) {
+                status.at(c) = "no maximum in paraboloid fit";
+            }
+            continue;
+        }
+
+        findRegion( likGrid, iMin, iMax, jMin, jMax, i0, j0 );
+        if ( !found || ( mutVec.front() + iMin*dmut < mutLo ) ) {
+            mutLo = mutVec.front() + iMin*dmut;
+        }
+        if ( !found || ( mutVec.front() + iMax*dmut > mutHi ) ) {
+            mutHi = mutVec.front() + iMax*dmut;
+        }
+        if ( !found || ( etaaVec.front() + jMin*detaa < etaaLo ) ) {
+            etaaLo = etaaVec.front() + jMin*detaa;
+        }
+        if ( !found || ( etaaVec.front() + jMax*detaa > etaaHi ) ) {
+            etaaHi = etaaVec.front() + jMax*detaa;
+        }
+        found = true;
+    }
+
+    if ( last ) {
+        return true;
+    }
+
+    if ( !found ) {
+        cerr << "Error: no curve in the batch has a maximum on the grid (in curveBatch.cpp)." << endl;
+        return false;
+    }
+
+    /* Update mut, etaa vectors to cover all regions. A region next to etaa = 0 can reach
+    below it, which has no meaning. */
+    if ( etaaLo < 0 ) {
+        etaaLo = 0;
+    }
+    mutVec = gridVec( mutLo, mutHi, mutSize );
+    etaaVec = gridVec( etaaLo, etaaHi, etaaSize );
+
+    progress << "mu_t bounds: (" << setprecision( 3 ) << mutVec.front() << ", " <<
+        setprecision( 3 ) <<  mutVec.back() << ")" << endl;
+
+    progress << "eta_a bounds: (" << setprecision( 3 ) << etaaVec.front() << ", "
+        << setprecision( 3 ) << etaaVec.back() << ")" << endl << endl;
+    return true;
+}
+
+/* Creates the batch output file, with one row per curve, after the time-to-solution and
+any report lines. */
+void CurveBatch::write( int timeCount, const vector<string>& report ) {
+    string fnFolder = "dataOut/MCSLbatch.csv";
+    ofstream saveData( fnFolder.c_str() );
+
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from curveBatch.cpp)." << endl;
+        return;
+    }
+
+    saveData << "Seconds elapsed: " << timeCount << " s" << endl;
+    for ( unsigned int k = 0; k < report.size(); k++ ) {
+        saveData << report.at(k) << endl;
+    }
+    saveData << "curve, mu_s, mu_a, coeff eta_a^2, coeff eta_a mu_t, coeff mu_t^2, "
+        << "eta_a, mu_t, status" << endl;
+    for ( unsigned int c = 0; c < curves.size(); c++ ) {
+        const vector<double>& p = param.at(c);
+        saveData << names.at(c) << ", " << p.at(4)*(1-p.at(3)) << ", " << p.at(4)*p.at(3);
+        for ( unsigned int i = 0; i < p.size(); i++ ) {
+            saveData << ", " << p.at(i);
+        }
+        saveData << ", " << status.at(c) << endl;
+    }
+}
@@ -0,0 +1,37 @@
+#include "contour.h"
+#include "discMax.h"
+#include "fileToVec.h"
+#include "findRegion.h"
+#include "gridVec.h"
+#include "reducedArs.h"
+#include "scoreParam.h"
+#include "subFromMax.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#pragma once
+
+class CurveBatch {
+    public:
+    CurveBatch();
+    bool read( const string& );
+    bool update( const vector<vector<vector<double> > >&, const ReducedArs&, vector<double>&,
+        vector<double>&, bool, ostream& );
+    void write( int, const vector<string>& );
+    vector<vector<double> > curves;
+    vector<string> names;
+    vector<vector<double> > param;
+    vector<string> status;
+
+    private:
+    vector<bool> active;
+};
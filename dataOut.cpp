@@ -4,11 +4,18 @@
 
 /* DataOut creates the output file for the program. It creates a
 file with the mean mua and mus values, the time-to-solution, and the
-likelihood paraboloid coefficients for Mathematica to use. */
+likelihood paraboloid coefficients for Mathematica to use. For a multi-layer
+material, the values of the layers below the first come first, and the first
+layer is saved last. If the index of
+refraction was scanned, it also saves the profile log-likelihood for each index
+and the fitted n. An adaptive run adds the report of why and when it stopped.
+The Mathematica parameters must stay at the end of the file, since the notebook
+reads the last five lines. */
 
 /******************************************************************************/
 
-void dataOut( const vector<double>& dataList, int timeCount ) {
+void dataOut( const vector<vector<double> >& layerList, int timeCount, const vector<double>& nVec,
+    const vector<double>& nProfile, const vector<double>& nFit, const vector<string>& report ) {
     string fnFolder = "dataOut/MCSLoutput.csv";
 
     /* Set up file to save to. */
@@ -18,8 +25,38 @@ void dataOut( const vector<double>& dataList, int timeCount ) {
     /* Check for opening error and save file */
     if ( saveData.is_open() ) {
         saveData << "Seconds elapsed: " << timeCount << " s" << endl;
+        for ( unsigned int l = 1; l < layerList.size(); l++ ) {
+            const vector<double>& dataList = layerList.at(l);
+            saveData << "Layer " << l+1 << ":" << endl;
+            saveData << "mu_s = " << dataList.at(4)*(1-dataList.at(3)) << endl;
+            saveData << "mu_a = " << dataList.at(4)*dataList.at(3) << endl;
+            saveData << "Parameters for Mathematica: " << endl;
+            for ( unsigned int i = 0; i < dataList.size(); i++ ) {
+                saveData << dataList.at(i) << endl;
+            }
+            saveData << endl;
+        }
+
+        const vector<double>& dataList = layerList.at(0);
+        if ( layerList.size() > 1 ) {
+            saveData << "Layer 1:" << endl;
+        }
         saveData << "mu_s = " << dataList.at(4)*(1-dataList.at(3)) << endl;
         saveData << "mu_a = " << dataList.at(4)*dataList.at(3) << endl << endl;
+        if ( nProfile.size() > 0 ) {
+            saveData << "Index of refraction scan (n, profile log-likelihood): " << endl;
+            for ( unsigned int k = 0; k < nVec.size(); k++ ) {
+                saveData << nVec.at(k) << ", " << nProfile.at(k) << endl;
+            }
+            saveData << "n = " << nFit.at(0) << endl;
+            saveData << "n standard error = " << nFit.at(1) << endl << endl;
+        }
+        for ( unsigned int k = 0; k < report.size(); k++ ) {
+            saveData << report.at(k) << endl;
+        }
+        if ( report.size() > 0 ) {
+            saveData << endl;
+        }
         saveData << "Parameters for Mathematica: " << endl;
         for ( unsigned int i = 0; i < dataList.size()-1; i++ ) {
             saveData << dataList.at(i);
@@ -7,4 +7,5 @@ using namespace std;
 
 #pragma once
 
-void dataOut( const vector<double>&, int );
+void dataOut( const vector<vector<double> >&, int, const vector<double>&, const vector<double>&,
+    const vector<double>&, const vector<string>& );
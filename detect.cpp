@@ -6,7 +6,14 @@
 the detector and assigns the particle's weight to the ARS vector.
 Detect calls intersect to determine the polar angle at which the particle
 hits the detector sphere and converts this to a position in the ARS
-vector. It adds the particle's weight to the ARS vector at this position. */
+vector. It adds the particle's weight to the ARS vector at this position. The other forms
+are named by what they tally into:
+    TallyKernel: the same ARS, with the tally kernel of the grid (see gridKernels.cpp)
+    FloatTally: the single precision tally of the stream (floatTally option)
+    TiledTally: an escape record in the shared tally of all threads (gridTiles option)
+    EscapeRing: an escape record in the ring of the transport thread (pipeline option)
+    vector<double>: the single ARS of a forward run at one point (see forwardPoint.cpp),
+        where the importance sampling weight is one, so only the scalar weight wScale */
 
 /* Variables:
     theta- the angle on the detector sphere where the particle intercepts it
@@ -14,7 +21,8 @@ vector. It adds the particle's weight to the ARS vector at this position. */
 
 /******************************************************************************/
 
-int detect( Particle &par, double radius, unsigned int angleDiv, vector<vector<vector<double> > > &ars , unsigned int m, unsigned int n ) {
+/* Returns the index in the ARS vector of the angle where the particle hits the detector */
+static unsigned int angleIndex( Particle &par, double radius, unsigned int angleDiv ) {
 	const double PI = 3.14159265358979323846;
     double theta;
     unsigned int ind;
@@ -27,6 +35,11 @@ int detect( Particle &par, double radius, unsigned int angleDiv, vector<vector<v
     if ( ind >= angleDiv ) {
         ind = angleDiv - 1;
     }
+    return ind;
+}
+
+int detect( Particle &par, double radius, unsigned int angleDiv, vector<vector<vector<double> > > &ars , unsigned int m, unsigned int n ) {
+    unsigned int ind = angleIndex( par, radius, angleDiv );
 
     /* Set the weight matrix to the outer product of the etaa and mut weight vectors */
     par.weight.updateMatrix();
@@ -41,3 +54,31 @@ int detect( Particle &par, double radius, unsigned int angleDiv, vector<vector<v
     /* Done with this particle */
     return 0;
 }
+
+int detect( Particle &par, double radius, unsigned int angleDiv, vector<vector<vector<double> > > &ars,
+    TallyKernel kernel ) {
+    kernel( par.weight, ars, angleIndex( par, radius, angleDiv ) );
+    return 0;
+}
+
+int detect( Particle &par, double radius, unsigned int angleDiv, FloatTally &tally ) {
+    unsigned int ind = angleIndex( par, radius, angleDiv );
+    par.weight.updateMatrix();
+    tally.add( par.weight.weightMatrix, ind );
+    return 0;
+}
+
+int detect( Particle &par, double radius, unsigned int angleDiv, TiledTally &tally, unsigned int thread ) {
+    tally.record( thread, par.weight, angleIndex( par, radius, angleDiv ) );
+    return 0;
+}
+
+int detect( Particle &par, double radius, unsigned int angleDiv, EscapeRing &ring, unsigned int batch ) {
+    ring.push( batch, par.weight, angleIndex( par, radius, angleDiv ) );
+    return 0;
+}
+
+int detect( Particle &par, double radius, unsigned int angleDiv, vector<double> &ars ) {
+    ars.at( angleIndex( par, radius, angleDiv ) ) += par.weight.wScale;
+    return 0;
+}
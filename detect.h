@@ -1,5 +1,9 @@
+#include "escapeRing.h"
+#include "floatTally.h"
+#include "gridKernels.h"
 #include "intersect.h"
 #include "particle.h"
+#include "tiledTally.h"
 #include <vector>
 
 using namespace std;
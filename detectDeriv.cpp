@@ -0,0 +1,60 @@
+#include "detectDeriv.h"
+
+/* DetectDeriv is the counterpart of detect for the trust region optimizer. Instead
+of the weight over a grid of mut and etaa, it adds the particle's weight at the
+reference point and the first and second derivatives of that weight with respect
+to mut and etaa to the derivative tally. The importance sampling weight of a single
+layer is
+
+    W = wScale * (mut/mut0)^k * exp( s*(mut0 - mut) ) * ((1 - etaa)/(1 - etaa0))^k
+
+for k collisions and path length s, so each derivative is W times a polynomial
+in k and s. It must be called before detect, which moves the particle onto the
+detector sphere. */
+
+/* Variables:
+    gm, ge: Derivatives of log(W) with respect to mut and etaa at the reference point
+    hmm, hee: Second derivatives of log(W) with respect to mut and etaa (the mixed one is 0)
+    tally: ARS of W, dW/dmut, dW/detaa, d2W/dmut2, d2W/dmut detaa and d2W/detaa2, in that
+        order, each stored as a 1 by angleDiv grid so that addVec and fixARS apply
+    theta- the angle on the detector sphere where the particle intercepts it
+    ind- the index in ARS corresponding to theta */
+
+/******************************************************************************/
+
+int detectDeriv( Particle &par, double radius, unsigned int angleDiv,
+    vector<vector<vector<double> > > &tally ) {
+	const double PI = 3.14159265358979323846;
+    double theta, w, k, s, mut0, etaa0, gm, ge, hmm, hee;
+    unsigned int ind;
+    vector<double> rVec = par.rVec;
+
+    theta = intersect( radius, rVec, par.dir );
+
+    /* Scale and round down the angle to put it into the ARS vector at the correct position */
+    ind = int( angleDiv * theta / PI );
+
+    if ( ind >= angleDiv ) {
+        ind = angleDiv - 1;
+    }
+
+    w = par.weight.wScale;
+    k = par.weight.numColl.at(0);
+    s = par.weight.pathLen.at(0);
+    mut0 = par.weight.mutRef.at(0);
+    etaa0 = par.weight.etaaRef.at(0);
+
+    gm = k / mut0 - s;
+    ge = -k / ( 1 - etaa0 );
+    hmm = -k / ( mut0 * mut0 );
+    hee = -k / ( ( 1 - etaa0 ) * ( 1 - etaa0 ) );
+
+    tally.at(0).at(0).at(ind) += w;
+    tally.at(1).at(0).at(ind) += w * gm;
+    tally.at(2).at(0).at(ind) += w * ge;
+    tally.at(3).at(0).at(ind) += w * ( gm * gm + hmm );
+    tally.at(4).at(0).at(ind) += w * gm * ge;
+    tally.at(5).at(0).at(ind) += w * ( ge * ge + hee );
+
+    return 0;
+}
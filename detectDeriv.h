@@ -0,0 +1,10 @@
+#include "intersect.h"
+#include "particle.h"
+#include <vector>
+
+using namespace std;
+
+#pragma once
+
+/* This file only holds directives because detectDeriv is defined inside of
+main.h, within the parallel for loop. */
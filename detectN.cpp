@@ -0,0 +1,60 @@
+#include "detectN.h"
+
+/* DetectN is the counterpart of detect for the scanned indices of refraction. The
+particle escaped at the reference index n0, so for every other index its exit
+direction is refracted differently. DetectN rebuilds the exit direction for each
+index from Snell's law, finds where it hits the detector and adds the particle's
+weight, scaled by the index weight, to the ARS vector for that index. It must be
+called before detect, which moves the particle onto the detector sphere. */
+
+/* Variables:
+    scale: Ratio of the transverse direction components at index nVec(k) and at n0
+    rho2: Square of the transverse direction component outside the medium
+    theta- the angle on the detector sphere where the particle intercepts it
+    ind- the index in ARS corresponding to theta */
+
+/******************************************************************************/
+
+int detectN( Particle &par, double n0, double radius, unsigned int angleDiv,
+    vector<vector<vector<vector<double> > > > &arsN, unsigned int m, unsigned int n ) {
+	const double PI = 3.14159265358979323846;
+    double theta, scale, rho2, wN;
+    unsigned int ind;
+    vector<double> rVec, dir( 3 );
+
+    /* Set the weight matrix to the outer product of the etaa and mut weight vectors */
+    par.weight.updateMatrix();
+
+    for ( unsigned int k = 0; k < par.weight.nVec.size(); k++ ) {
+        wN = par.weight.weightN.at(k);
+
+        /* Total internal reflection at this index: the particle could not have escaped */
+        scale = par.weight.nVec.at(k) / n0;
+        rho2 = scale*scale * ( par.dir.at(0)*par.dir.at(0) + par.dir.at(1)*par.dir.at(1) );
+        if ( ( wN <= 0 ) || ( rho2 >= 1 ) ) {
+            continue;
+        }
+
+        dir.at(0) = scale * par.dir.at(0);
+        dir.at(1) = scale * par.dir.at(1);
+        dir.at(2) = ( par.dir.at(2) > 0 ) ? sqrt( 1 - rho2 ) : -sqrt( 1 - rho2 );
+
+        /* Scale and round down the angle to put it into the ARS vector at the correct position */
+        rVec = par.rVec;
+        theta = intersect( radius, rVec, dir );
+        ind = int( angleDiv * theta / PI );
+
+        if ( ind >= angleDiv ) {
+            ind = angleDiv - 1;
+        }
+
+        /* Add the weight matrix element-wise to the ARS vector for this index */
+        for ( unsigned int i = 0; i < m; i++ ) {
+            for ( unsigned int j = 0; j < n; j++) {
+                arsN.at(k).at(i).at(j).at(ind) += wN * par.weight.weightMatrix.at(i).at(j);
+            }
+        }
+    }
+
+    return 0;
+}
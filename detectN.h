@@ -0,0 +1,11 @@
+#include "intersect.h"
+#include "particle.h"
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+#pragma once
+
+/* This file only holds directives because detectN is defined inside of
+main.h, within the parallel for loop. */
@@ -3,12 +3,12 @@
 /* Written by Richelle Streater, June 2017. */
 
 /* DiscMax finds the location of the discrete maximum of a grid of values. DiscMax
-returns false if the maximum falls on an edge. */
+returns false if the maximum falls on an edge, and says so if verbose is TRUE. */
 
 /******************************************************************************/
 
 bool discMax( const vector<vector<double> >& grid, int& iMax, int& jMax,
-    unsigned int mutSize, unsigned int etaaSize ) {
+    unsigned int mutSize, unsigned int etaaSize, bool verbose ) {
 
     double maxVal = grid.at(0).at(0);
 
@@ -25,7 +25,9 @@ bool discMax( const vector<vector<double> >& grid, int& iMax, int& jMax,
 
     /* Check to see if there is a real maximum, or if it is on the edges */
     if ( (iMax < 1) || (jMax < 1) || (iMax > mutSize-2) || (jMax > etaaSize-2) ) {
-        cerr << "Error: Maximum out of bounds (from discMax.cpp)" << endl;
+        if ( verbose ) {
+            cerr << "Error: Maximum out of bounds (from discMax.cpp)" << endl;
+        }
         return false;
     }
     return true;
@@ -6,4 +6,4 @@ using namespace std;
 #pragma once
 
 bool discMax( const vector<vector<double> >&, int&, int&,
-    unsigned int, unsigned int );
+    unsigned int, unsigned int, bool );
@@ -0,0 +1,239 @@
+#include "escapeLog.h"
+
+/* EscapeLog is a binary log of every photon that escapes the material in a forward run
+(escapeLog option), from which the ARS can be tallied again offline for any detector
+radius, number of angles or search grid (see tools/rebinLog.cpp), without simulating the
+photons again. Each photon is logged with its position and direction where it leaves the
+material, wScale, and the collisions and path length in each layer, which with the
+reference mut and etaa of the run is all that its importance sampling weights depend on.
+The streams keep their records in a buffer each, and write them to the file in chunks of
+CHUNK records, one stream at a time. The log is read back by mapping the file into memory,
+or without memory maps (_WIN32) by reading it into a buffer.
+
+File layout, all in 8-byte words of the machine that wrote it:
+    header: "MCSLESC1", layers, photons sent, angleDiv, radius, and the reference mut and
+        etaa of each layer
+    chunks: the number of records, then the records, each of x, y, z, ux, uy, uz, wScale,
+        and the collisions (as a double) and path length of each layer
+The photons are only known at the end of the run, so close writes them into the header. */
+
+/* Members:
+    on: Whether a log is open for writing
+    layers, photons, angleDiv, radius, mutRef, etaaRef: The header of the mapped log
+    chunkStart, chunkCount: The first record and the records of each chunk of the mapped log
+    out, buffers, failed: The file being written, the records of each stream that are not
+        written yet, and whether a write failed
+    mapped, mappedSize: The mapped file and its size in bytes
+    buffer: The file read into memory, without memory maps (_WIN32)
+*/
+
+/******************************************************************************/
+
+static const char MAGIC[] = "MCSLESC1";
+static const unsigned int CHUNK = 4096;
+
+EscapeLog::EscapeLog() {
+    on = false;
+    failed = false;
+    layers = 0;
+    photons = 0;
+    angleDiv = 0;
+    radius = 0;
+    mapped = NULL;
+    mappedSize = 0;
+}
+
+EscapeLog::~EscapeLog() {
+    unmap();
+}
+
+/* Words of one record */
+unsigned int EscapeLog::recordSize() const {
+    return 7 + 2 * layers;
+}
+
+/* Starts a log at path for a run of the layers of layerVec (at their reference mut and
+etaa), with a detector of radius radiusIn, angleDivIn angle divisions and numStreams
+streams. An existing file is replaced. Returns FALSE if the file did not open. */
+bool EscapeLog::open( const string& path, vector<Layer>& layerVec, double radiusIn, unsigned int angleDivIn,
+    unsigned int numStreams ) {
+    out.close();
+    out.clear();
+    out.open( path.c_str(), ios::binary | ios::trunc );
+    if ( !out.is_open() ) {
+        cerr << "Error: could not open escape log " << path << " (from escapeLog.cpp)." << endl;
+        return false;
+    }
+    layers = layerVec.size();
+    photons = 0;
+    angleDiv = angleDivIn;
+    radius = radiusIn;
+    mutRef.resize( layers );
+    etaaRef.resize( layers );
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        mutRef.at(l) = layerVec.at(l).getMut();
+        etaaRef.at(l) = layerVec.at(l).getMua() / layerVec.at(l).getMut();
+    }
+
+    out.write( MAGIC, 8 );
+    out.write( (const char*) &layers, 8 );
+    out.write( (const char*) &photons, 8 );
+    out.write( (const char*) &angleDiv, 8 );
+    out.write( (const char*) &radius, 8 );
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        out.write( (const char*) &mutRef.at(l), 8 );
+        out.write( (const char*) &etaaRef.at(l), 8 );
+    }
+    buffers.assign( numStreams, vector<double>() );
+    for ( unsigned int n = 0; n < numStreams; n++ ) {
+        buffers.at(n).reserve( CHUNK * recordSize() );
+    }
+    failed = false;
+    on = true;
+    return true;
+}
+
+/* Logs the particle of stream n as it escapes, before detect moves it onto the detector */
+void EscapeLog::add( unsigned int n, const Particle& par ) {
+    vector<double>& buffer = buffers.at(n);
+    buffer.insert( buffer.end(), par.rVec.begin(), par.rVec.end() );
+    buffer.insert( buffer.end(), par.dir.begin(), par.dir.end() );
+    buffer.push_back( par.weight.wScale );
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        buffer.push_back( par.weight.numColl.at(l) );
+        buffer.push_back( par.weight.pathLen.at(l) );
+    }
+    if ( buffer.size() >= CHUNK * recordSize() ) {
+        write( buffer );
+    }
+}
+
+/* Writes the records of buffer as one chunk and clears it */
+void EscapeLog::write( vector<double>& buffer ) {
+    unsigned long long count = buffer.size() / recordSize();
+    if ( count == 0 ) {
+        return;
+    }
+    #pragma omp critical(escapeLog)
+    {
+        out.write( (const char*) &count, 8 );
+        out.write( (const char*) &buffer[0], buffer.size() * sizeof( double ) );
+        failed = failed || out.fail();
+    }
+    buffer.clear();
+}
+
+/* Writes the records left in the buffers and the photons sent in the run, photonsIn, and
+closes the log. Returns FALSE if a write failed. */
+bool EscapeLog::close( unsigned long long photonsIn ) {
+    for ( unsigned int n = 0; n < buffers.size(); n++ ) {
+        write( buffers.at(n) );
+    }
+    photons = photonsIn;
+    out.seekp( 16 );
+    out.write( (const char*) &photons, 8 );
+    failed = failed || out.fail();
+    out.close();
+    buffers.clear();
+    on = false;
+    if ( failed ) {
+        cerr << "Error: could not write the escape log (from escapeLog.cpp)." << endl;
+        return false;
+    }
+    return true;
+}
+
+/* Maps the log at path into memory, reads its header and finds its chunks. Returns FALSE if
+the file cannot be mapped or is not a whole log. */
+bool EscapeLog::map( const string& path ) {
+    unmap();
+#ifndef _WIN32
+    int fd = ::open( path.c_str(), O_RDONLY );
+    struct stat info;
+    if ( ( fd < 0 ) || ( fstat( fd, &info ) != 0 ) ) {
+        cerr << "Error: could not open escape log " << path << " (from escapeLog.cpp)." << endl;
+        if ( fd >= 0 ) {
+            ::close( fd );
+        }
+        return false;
+    }
+    mappedSize = info.st_size;
+    void* data = ( mappedSize > 0 ) ? mmap( NULL, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0 ) : MAP_FAILED;
+    ::close( fd );
+    if ( data == MAP_FAILED ) {
+        cerr << "Error: could not map escape log " << path << " (from escapeLog.cpp)." << endl;
+        mappedSize = 0;
+        return false;
+    }
+    mapped = (const char*) data;
+    madvise( data, mappedSize, MADV_SEQUENTIAL );
+#else
+    ifstream in( path.c_str(), ios::binary | ios::ate );
+    if ( !in.is_open() ) {
+        cerr << "Error: could not open escape log " << path << " (from escapeLog.cpp)." << endl;
+        return false;
+    }
+    mappedSize = in.tellg();
+    buffer.resize( mappedSize / 8 + 1 );
+    in.seekg( 0 );
+    in.read( (char*) &buffer[0], mappedSize );
+    if ( in.fail() ) {
+        cerr << "Error: could not read escape log " << path << " (from escapeLog.cpp)." << endl;
+        buffer.clear();
+        mappedSize = 0;
+        return false;
+    }
+    mapped = (const char*) &buffer[0];
+#endif
+
+    const unsigned long long* word = (const unsigned long long*) mapped;
+    size_t words = mappedSize / 8;
+    if ( ( words < 5 ) || ( memcmp( mapped, MAGIC, 8 ) != 0 ) || ( word[1] == 0 ) || ( words < 5 + 2 * word[1] ) ) {
+        cerr << "Error: " << path << " is not an escape log (from escapeLog.cpp)." << endl;
+        unmap();
+        return false;
+    }
+    layers = word[1];
+    photons = word[2];
+    angleDiv = word[3];
+    const double* value = (const double*) mapped;
+    radius = value[4];
+    mutRef.resize( layers );
+    etaaRef.resize( layers );
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        mutRef.at(l) = value[ 5 + 2*l ];
+        etaaRef.at(l) = value[ 6 + 2*l ];
+    }
+
+    /* Each chunk starts with the number of its records */
+    size_t k = 5 + 2 * layers;
+    chunkStart.clear();
+    chunkCount.clear();
+    while ( k < words ) {
+        unsigned long long count = word[k];
+        if ( ( count == 0 ) || ( count > ( words - k - 1 ) / recordSize() ) ) {
+            cerr << "Error: escape log " << path << " ends within a chunk (from escapeLog.cpp)." << endl;
+            unmap();
+            return false;
+        }
+        chunkStart.push_back( value + k + 1 );
+        chunkCount.push_back( count );
+        k += 1 + count * recordSize();
+    }
+    return true;
+}
+
+/* Releases the mapped log */
+void EscapeLog::unmap() {
+#ifndef _WIN32
+    if ( mapped != NULL ) {
+        munmap( (void*) mapped, mappedSize );
+    }
+#else
+    buffer.clear();
+#endif
+    mapped = NULL;
+    mappedSize = 0;
+    chunkStart.clear();
+    chunkCount.clear();
+}
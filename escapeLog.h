@@ -0,0 +1,46 @@
+#include "layer.h"
+#include "particle.h"
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+#pragma once
+
+class EscapeLog {
+    public:
+    EscapeLog();
+    ~EscapeLog();
+    bool open( const string&, vector<Layer>&, double, unsigned int, unsigned int );
+    void add( unsigned int, const Particle& );
+    bool close( unsigned long long );
+    bool map( const string& );
+    void unmap();
+    unsigned int recordSize() const;
+    bool on;
+
+    /* Read from the header (map) */
+    unsigned long long layers, photons, angleDiv;
+    double radius;
+    vector<double> mutRef, etaaRef;
+    vector<const double*> chunkStart;
+    vector<unsigned long long> chunkCount;
+
+    private:
+    void write( vector<double>& );
+    ofstream out;
+    vector<vector<double> > buffers;
+    bool failed;
+    const char* mapped;
+    size_t mappedSize;
+    vector<double> buffer;
+};
@@ -0,0 +1,97 @@
+#include "escapeRing.h"
+
+/* EscapeRing is a lock-free ring buffer of escape records from one transport thread to one
+tally thread (pipeline option). Detect pushes the record of each photon it detects (the
+batch, the angle index, wScale, and the collisions and path length in each layer), which is
+all that the weight matrix of the photon depends on, and the tally thread pops the records
+in the same order and adds their weight matrices to the tallies of their batches. Only the
+transport thread moves tail and only the tally thread moves head, so each index is written
+by one thread, and the release store of one and the acquire load of the other make the
+slots between them safe to read. A full ring makes the transport thread wait, and an empty
+one the tally thread. */
+
+/* Members:
+    batch, ind, wScale: Batch, angle index and scalar weight of the record in each slot
+    numColl, pathLen: Collisions and path length in each layer of the record in each slot
+    mask, layers: Slots minus one (a power of two minus one), and layers of the material
+    head, tail: Records popped and pushed so far, on cache lines of their own
+    done: Whether the transport thread has pushed its last record
+*/
+
+/******************************************************************************/
+
+EscapeRing::EscapeRing() : head( 0 ), tail( 0 ), done( false ) {
+    mask = 0;
+    layers = 0;
+}
+
+/* Makes room for at least capacity records of layersIn layers */
+void EscapeRing::init( unsigned int capacity, unsigned int layersIn ) {
+    unsigned long long size = 1;
+    while ( size < capacity ) {
+        size *= 2;
+    }
+    mask = size - 1;
+    layers = layersIn;
+    batch.assign( size, 0 );
+    ind.assign( size, 0 );
+    wScale.assign( size, 0 );
+    numColl.assign( size * layers, 0 );
+    pathLen.assign( size * layers, 0 );
+    open();
+}
+
+/* Empties the ring for the next transport loop. Not called while either thread uses it. */
+void EscapeRing::open() {
+    head.store( 0 );
+    tail.store( 0 );
+    done.store( false );
+}
+
+/* Marks that the transport thread has pushed its last record */
+void EscapeRing::close() {
+    done.store( true, memory_order_release );
+}
+
+/* Whether the transport thread is done. The records it pushed before are then visible to a
+pop after this call. */
+bool EscapeRing::closed() const {
+    return done.load( memory_order_acquire );
+}
+
+/* Writes the record of a photon of batch b detected at angle index indIn, once the ring has
+room for it */
+void EscapeRing::push( unsigned int b, const Weight& weight, unsigned int indIn ) {
+    unsigned long long t = tail.load( memory_order_relaxed );
+    while ( t - head.load( memory_order_acquire ) > mask ) {
+        this_thread::yield();
+    }
+    unsigned long long s = t & mask;
+    batch[s] = b;
+    ind[s] = indIn;
+    wScale[s] = weight.wScale;
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        numColl[ s*layers + l ] = weight.numColl[l];
+        pathLen[ s*layers + l ] = weight.pathLen[l];
+    }
+    tail.store( t+1, memory_order_release );
+}
+
+/* Reads the oldest record into the counts of weight and its batch and angle index. Returns
+FALSE if the ring is empty. */
+bool EscapeRing::pop( Weight& weight, unsigned int& b, unsigned int& indOut ) {
+    unsigned long long h = head.load( memory_order_relaxed );
+    if ( h == tail.load( memory_order_acquire ) ) {
+        return false;
+    }
+    unsigned long long s = h & mask;
+    b = batch[s];
+    indOut = ind[s];
+    weight.wScale = wScale[s];
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        weight.numColl[l] = numColl[ s*layers + l ];
+        weight.pathLen[l] = pathLen[ s*layers + l ];
+    }
+    head.store( h+1, memory_order_release );
+    return true;
+}
@@ -0,0 +1,32 @@
+#include "weight.h"
+#include <vector>
+#include <iostream>
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+#pragma once
+
+class EscapeRing {
+    public:
+    EscapeRing();
+    void init( unsigned int, unsigned int );
+    void open();
+    void close();
+    bool closed() const;
+    void push( unsigned int, const Weight&, unsigned int );
+    bool pop( Weight&, unsigned int&, unsigned int& );
+
+    private:
+    vector<unsigned int> batch, ind, numColl;
+    vector<double> wScale, pathLen;
+    unsigned long long mask;
+    unsigned int layers;
+    char pad0[64];
+    atomic<unsigned long long> head;
+    char pad1[64];
+    atomic<unsigned long long> tail;
+    atomic<bool> done;
+    char pad2[64];
+};
@@ -0,0 +1,104 @@
+#include "escapeTally.h"
+
+/* EscapeTally tallies the photons that escape in a forward run of inverse, the same way
+for every chunk of it, so that the transport loop only calls escape when a photon leaves
+the material, endPhoton after every photon, and endBatch after every batch. By default, a
+photon is added to the ARS of its batch with the tally kernel of the grid. The options
+that change this each set a pointer to their tallies, which is NULL otherwise:
+    log: Every escaping photon is logged first (escapeLog option, see escapeLog.cpp)
+    arsNProc: The photon is also reweighted to each index of the n grid, with nRef the
+        index of the run (nGrid option, see detectN.cpp)
+    derivProc: The derivatives of the ARS are tallied too (trustRegion option, see
+        detectDeriv.cpp)
+    floatProc: Each stream tallies in single precision, and adds it into the ARS of its
+        batch every block photons and at the end of the batch (floatTally option, see
+        floatTally.cpp)
+    tiles: All threads write escape records to one shared buffer and flush it together
+        into the one tally (gridTiles option, see tiledTally.cpp)
+    rings: The records are pushed to the ring of the transport thread, and tallied by the
+        tally threads (pipeline option, see escapeRing.cpp)
+Only one of floatProc, tiles and rings may be set. */
+
+/* Members:
+    arsProc: The ARS tally of each batch, or the one shared tally (gridTiles option)
+    radius, angleDiv: Radius of the detector, and number of divisions of the ARS
+    mutSize, etaaSize: Number of mut and etaa combinations over all layers
+    kernel: The tally kernel for the size of the grid
+*/
+
+/******************************************************************************/
+
+EscapeTally::EscapeTally( vector<vector<vector<vector<double> > > >& arsProcIn, double radiusIn,
+    unsigned int angleDivIn, unsigned int mutSizeIn, unsigned int etaaSizeIn, unsigned int layers ) {
+    arsProc = &arsProcIn;
+    radius = radiusIn;
+    angleDiv = angleDivIn;
+    mutSize = mutSizeIn;
+    etaaSize = etaaSizeIn;
+    kernel = tallyKernel( mutSize, etaaSize, layers );
+    log = NULL;
+    arsNProc = NULL;
+    nRef = 0;
+    derivProc = NULL;
+    floatProc = NULL;
+    tiles = NULL;
+    rings = NULL;
+}
+
+/* Tallies the escaping photon par of stream n, whose batch is b, and returns the next
+state of the photon (0) */
+int EscapeTally::escape( Particle& par, unsigned int n, unsigned int b ) {
+    int detectN( Particle&, double, double, unsigned int, vector<vector<vector<vector<double> > > >&,
+        unsigned int, unsigned int );
+    int detectDeriv( Particle&, double, unsigned int, vector<vector<vector<double> > >& );
+    int detect( Particle&, double, unsigned int, FloatTally& );
+    int detect( Particle&, double, unsigned int, TiledTally&, unsigned int );
+    int detect( Particle&, double, unsigned int, EscapeRing&, unsigned int );
+    int detect( Particle&, double, unsigned int, vector<vector<vector<double> > >&, TallyKernel );
+    int state;
+
+    if ( log ) {
+        log->add( n, par );
+    }
+    if ( arsNProc ) {
+        detectN( par, nRef, radius, angleDiv, arsNProc->at(n), mutSize, etaaSize );
+    }
+    if ( derivProc ) {
+        detectDeriv( par, radius, angleDiv, derivProc->at(n) );
+    }
+    if ( floatProc ) {
+        state = detect( par, radius, angleDiv, floatProc->at(n) );
+        if ( floatProc->at(n).full() ) {
+            floatProc->at(n).flush( arsProc->at(b) );
+        }
+        return state;
+    }
+    if ( tiles ) {
+        return detect( par, radius, angleDiv, *tiles, n );
+    }
+    if ( rings ) {
+        return detect( par, radius, angleDiv, rings->at( n % rings->size() ), b );
+    }
+    return detect( par, radius, angleDiv, arsProc->at(b), kernel );
+}
+
+/* Ends a photon of stream n, whether it escaped or not. The shared tally is flushed when
+the buffer of the thread is full, which every thread reaches after the same photon. */
+void EscapeTally::endPhoton( Particle& par, unsigned int n ) {
+    if ( tiles ) {
+        tiles->endPhoton( n );
+        if ( tiles->full( n ) ) {
+            tiles->flush( n, par.weight, arsProc->at(0) );
+        }
+    }
+}
+
+/* Ends batch b of stream n, adding what the stream still holds into the tally */
+void EscapeTally::endBatch( Particle& par, unsigned int n, unsigned int b ) {
+    if ( floatProc ) {
+        floatProc->at(n).flush( arsProc->at(b) );
+    }
+    if ( tiles ) {
+        tiles->flush( n, par.weight, arsProc->at(0) );
+    }
+}
@@ -0,0 +1,34 @@
+#include "detect.h"
+#include "escapeLog.h"
+#include "escapeRing.h"
+#include "floatTally.h"
+#include "gridKernels.h"
+#include "particle.h"
+#include "tiledTally.h"
+#include <vector>
+
+using namespace std;
+
+#pragma once
+
+class EscapeTally {
+    public:
+    EscapeTally( vector<vector<vector<vector<double> > > >&, double, unsigned int, unsigned int, unsigned int,
+        unsigned int );
+    int escape( Particle&, unsigned int, unsigned int );
+    void endPhoton( Particle&, unsigned int );
+    void endBatch( Particle&, unsigned int, unsigned int );
+    EscapeLog* log;
+    vector<vector<vector<vector<vector<double> > > > >* arsNProc;
+    double nRef;
+    vector<vector<vector<vector<double> > > >* derivProc;
+    vector<FloatTally>* floatProc;
+    TiledTally* tiles;
+    vector<EscapeRing>* rings;
+
+    private:
+    vector<vector<vector<vector<double> > > >* arsProc;
+    double radius;
+    unsigned int angleDiv, mutSize, etaaSize;
+    TallyKernel kernel;
+};
@@ -0,0 +1,209 @@
+#include "eventCounters.h"
+#include "ranks.h"
+
+/* EventCounters tallies what the photons of a forward run do: their scatters, boundary
+hits, total internal and Fresnel reflections at a boundary, crossings into another layer,
+escapes through the top (reflected) and the bottom (transmitted) of the material, and
+roulette kills and survivals, with a histogram of the steps (propagate calls) of each
+photon. It also tallies the scalar weight at the reference point that leaves the photons:
+the specular reflectance, the diffuse reflectance and transmittance, and the weight
+absorbed at the collisions. Roulette adds and removes weight, so the sum of these is one
+per photon on average, and exactly one plus the net weight of roulette. Each stream of a
+forward run counts into the particle it sends, which is added up after the transport
+loop. The counters are only in a build with COUNT_EVENTS (see COUNT_EVENT). */
+
+/* Members:
+    photons, steps: Photons sent, and their steps in all
+    photonSteps: Steps of the photon that is being sent
+    scatters, boundaryHits: Collisions, and steps that ended on a boundary
+    totalInternal, fresnelReflections: Reflections at a boundary, beyond the critical angle or by
+        the Fresnel coefficient
+    layerCrossings: Transmissions from one layer into the next
+    escapesReflected, escapesTransmitted: Photons that left through the top and the bottom
+    rouletteKills, rouletteSurvivals: Outcomes of roulette
+    stepHist: Photons by their steps, in bins of 1, 2-3, 4-7, ... (the last bin has the rest)
+    specular, reflected, transmitted, absorbed: Weight reflected at the surface, escaped through
+        the top and the bottom, and absorbed
+    rouletteGained, rouletteLost: Weight added to the photons that survived roulette, and taken
+        from the ones it killed
+*/
+
+/******************************************************************************/
+
+EventCounters::EventCounters() {
+    photons = 0;
+    steps = 0;
+    photonSteps = 0;
+    scatters = 0;
+    boundaryHits = 0;
+    totalInternal = 0;
+    fresnelReflections = 0;
+    layerCrossings = 0;
+    escapesReflected = 0;
+    escapesTransmitted = 0;
+    rouletteKills = 0;
+    rouletteSurvivals = 0;
+    stepHist.assign( 24, 0 );
+    specular = 0;
+    reflected = 0;
+    transmitted = 0;
+    absorbed = 0;
+    rouletteGained = 0;
+    rouletteLost = 0;
+}
+
+/* Closes the photon that was sent, which lost specular of its weight at the surface */
+void EventCounters::endPhoton( double spec ) {
+    unsigned int bin = 0;
+    while ( ( photonSteps >> ( bin+1 ) ) && ( bin < stepHist.size()-1 ) ) {
+        bin++;
+    }
+    stepHist.at( bin )++;
+    steps += photonSteps;
+    photonSteps = 0;
+    photons++;
+    specular += spec;
+}
+
+void EventCounters::add( const EventCounters& other ) {
+    photons += other.photons;
+    steps += other.steps;
+    scatters += other.scatters;
+    boundaryHits += other.boundaryHits;
+    totalInternal += other.totalInternal;
+    fresnelReflections += other.fresnelReflections;
+    layerCrossings += other.layerCrossings;
+    escapesReflected += other.escapesReflected;
+    escapesTransmitted += other.escapesTransmitted;
+    rouletteKills += other.rouletteKills;
+    rouletteSurvivals += other.rouletteSurvivals;
+    for ( unsigned int k = 0; k < stepHist.size(); k++ ) {
+        stepHist.at(k) += other.stepHist.at(k);
+    }
+    specular += other.specular;
+    reflected += other.reflected;
+    transmitted += other.transmitted;
+    absorbed += other.absorbed;
+    rouletteGained += other.rouletteGained;
+    rouletteLost += other.rouletteLost;
+}
+
+/* Adds up the counters of all ranks (MPI build). The counts are exact in doubles up to 2^53. */
+void EventCounters::reduce() {
+    if ( Ranks::size() < 2 ) {
+        return;
+    }
+    unsigned long long* counts[] = { &photons, &steps, &scatters, &boundaryHits, &totalInternal,
+        &fresnelReflections, &layerCrossings, &escapesReflected, &escapesTransmitted, &rouletteKills,
+        &rouletteSurvivals };
+    double* weights[] = { &specular, &reflected, &transmitted, &absorbed, &rouletteGained, &rouletteLost };
+    unsigned int numCounts = sizeof( counts ) / sizeof( counts[0] );
+    unsigned int numWeights = sizeof( weights ) / sizeof( weights[0] );
+
+    vector<vector<vector<double> > > tally( 1, vector<vector<double> >( 1 ) );
+    vector<double>& flat = tally.at(0).at(0);
+    for ( unsigned int k = 0; k < numCounts; k++ ) {
+        flat.push_back( *counts[k] );
+    }
+    flat.insert( flat.end(), stepHist.begin(), stepHist.end() );
+    for ( unsigned int k = 0; k < numWeights; k++ ) {
+        flat.push_back( *weights[k] );
+    }
+
+    Ranks::reduce( tally );
+
+    unsigned int i = 0;
+    for ( unsigned int k = 0; k < numCounts; k++ ) {
+        *counts[k] = flat.at( i++ );
+    }
+    for ( unsigned int k = 0; k < stepHist.size(); k++ ) {
+        stepHist.at(k) = flat.at( i++ );
+    }
+    for ( unsigned int k = 0; k < numWeights; k++ ) {
+        *weights[k] = flat.at( i++ );
+    }
+}
+
+/* Returns the weight per photon that is not accounted for: the specular and diffuse
+reflectance, transmittance and absorbed weight, less one and the net weight of roulette.
+It is zero up to round off, unless a photon was lost. */
+double EventCounters::balanceError() const {
+    if ( photons == 0 ) {
+        return 0;
+    }
+    return ( specular + reflected + transmitted + absorbed - rouletteGained + rouletteLost ) / photons - 1;
+}
+
+/* Returns the lines on iteration it: the events per photon, the steps per photon, and the
+weight balance at the reference point */
+vector<string> EventCounters::summary( unsigned int it ) const {
+    vector<string> lines;
+    ostringstream events, stepLine, balance;
+    double n = ( photons > 0 ) ? double( photons ) : 1;
+
+    events << setprecision( 4 ) << "Events in iteration " << it+1 << ": " << photons << " photons; per photon: "
+        << scatters / n << " scatters, " << boundaryHits / n << " boundary hits, " << totalInternal / n
+        << " total internal reflections, " << fresnelReflections / n << " Fresnel reflections, "
+        << layerCrossings / n << " layer crossings, " << escapesReflected / n << " escaped reflected, "
+        << escapesTransmitted / n << " escaped transmitted, " << rouletteKills / n << " roulette kills, "
+        << rouletteSurvivals / n << " roulette survivals";
+    lines.push_back( events.str() );
+
+    stepLine << setprecision( 4 ) << "Steps per photon in iteration " << it+1 << ": mean " << steps / n << ";";
+    for ( unsigned int k = 0; k < stepHist.size(); k++ ) {
+        if ( stepHist.at(k) == 0 ) {
+            continue;
+        }
+        stepLine << " " << ( 1ULL << k );
+        if ( k == stepHist.size()-1 ) {
+            stepLine << "+";
+        }
+        else if ( k > 0 ) {
+            stepLine << "-" << ( 2ULL << k ) - 1;
+        }
+        stepLine << ": " << stepHist.at(k);
+    }
+    lines.push_back( stepLine.str() );
+
+    balance << setprecision( 6 ) << "Weight balance in iteration " << it+1 << ": specular " << specular / n
+        << " + reflected " << reflected / n << " + transmitted " << transmitted / n << " + absorbed "
+        << absorbed / n << " = " << ( specular + reflected + transmitted + absorbed ) / n
+        << " (roulette net " << ( rouletteGained - rouletteLost ) / n << ", unaccounted "
+        << setprecision( 2 ) << balanceError() << ")";
+    lines.push_back( balance.str() );
+    return lines;
+}
+
+/* Writes one row per iteration to path, with every counter, the weight per photon of each
+kind and the photons in each bin of steps. Returns FALSE if the file did not open. */
+bool EventCounters::write( const string& path, const vector<EventCounters>& iterations ) {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from eventCounters.cpp)." << endl;
+        return false;
+    }
+
+    saveData << "iteration, photons, steps, scatters, boundary hits, total internal reflections, "
+        << "Fresnel reflections, layer crossings, escaped reflected, escaped transmitted, roulette kills, "
+        << "roulette survivals, specular, reflected, transmitted, absorbed, roulette net, unaccounted";
+    for ( unsigned int k = 0; k < EventCounters().stepHist.size(); k++ ) {
+        saveData << ", steps from " << ( 1ULL << k );
+    }
+    saveData << endl;
+    saveData << setprecision( 10 );
+    for ( unsigned int it = 0; it < iterations.size(); it++ ) {
+        const EventCounters& c = iterations.at(it);
+        double n = ( c.photons > 0 ) ? double( c.photons ) : 1;
+        saveData << it+1 << ", " << c.photons << ", " << c.steps << ", " << c.scatters << ", " << c.boundaryHits
+            << ", " << c.totalInternal << ", " << c.fresnelReflections << ", " << c.layerCrossings << ", "
+            << c.escapesReflected << ", " << c.escapesTransmitted << ", " << c.rouletteKills << ", "
+            << c.rouletteSurvivals << ", " << c.specular / n << ", " << c.reflected / n << ", "
+            << c.transmitted / n << ", " << c.absorbed / n << ", " << ( c.rouletteGained - c.rouletteLost ) / n
+            << ", " << c.balanceError();
+        for ( unsigned int k = 0; k < c.stepHist.size(); k++ ) {
+            saveData << ", " << c.stepHist.at(k);
+        }
+        saveData << endl;
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+#pragma once
+
+/* COUNT_EVENT( statement ) runs statement only in a build with COUNT_EVENTS, so that the
+counters cost nothing otherwise */
+#ifdef COUNT_EVENTS
+#define COUNT_EVENT( statement ) statement
+#else
+#define COUNT_EVENT( statement )
+#endif
+
+class EventCounters {
+    public:
+    EventCounters();
+    void endPhoton( double );
+    void add( const EventCounters& );
+    void reduce();
+    double balanceError() const;
+    vector<string> summary( unsigned int ) const;
+    static bool write( const string&, const vector<EventCounters>& );
+    unsigned long long photons, steps, photonSteps, scatters, boundaryHits, totalInternal,
+        fresnelReflections, layerCrossings, escapesReflected, escapesTransmitted, rouletteKills,
+        rouletteSurvivals;
+    vector<unsigned long long> stepHist;
+    double specular, reflected, transmitted, absorbed, rouletteGained, rouletteLost;
+};
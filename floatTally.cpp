@@ -0,0 +1,89 @@
+#include "floatTally.h"
+
+/* FloatTally is the ARS tally of one stream in single precision (floatTally option). Detect
+adds the weight matrix of each photon into it, which touches half the memory of the double
+tallies, and every block photons, and at the end of each batch, the tally is added into
+the double tally of the batch and cleared. A bin gets at most one weight per photon, so
+it never sums more than block weights in single precision, and its rounding error stays
+below about block times 6e-8 of its value, however many photons the run sends (blockwise
+pairwise summation). With the check flag, every weight is also added to a double tally,
+which flushExact hands over, to compare the two (see inverse.cpp). */
+
+/* Members:
+    sum: The weights since the last flush, at i*n*angleDiv + j*angleDiv + ind for mut i,
+        etaa j and angle index ind
+    exact: The same weights in double precision since the start (check flag), or empty
+    m, n, angleDiv: Size of the mut and etaa grids and number of angle divisions
+    block, photons: Photons between two flushes, and photons since the last flush
+*/
+
+/******************************************************************************/
+
+FloatTally::FloatTally() {
+    m = 0;
+    n = 0;
+    angleDiv = 0;
+    block = 1;
+    photons = 0;
+}
+
+FloatTally::FloatTally( unsigned int mIn, unsigned int nIn, unsigned int angleDivIn, unsigned int blockIn,
+    bool check ) {
+    m = mIn;
+    n = nIn;
+    angleDiv = angleDivIn;
+    block = blockIn;
+    photons = 0;
+    sum.assign( m * n * angleDiv, 0 );
+    if ( check ) {
+        exact.assign( m * n * angleDiv, 0 );
+    }
+}
+
+/* Adds the weight matrix of a photon detected at angle index ind */
+void FloatTally::add( const vector<vector<double> >& weightMatrix, unsigned int ind ) {
+    float* bin = &sum[ind];
+    for ( unsigned int i = 0; i < m; i++ ) {
+        const vector<double>& row = weightMatrix[i];
+        for ( unsigned int j = 0; j < n; j++ ) {
+            *bin += float( row[j] );
+            bin += angleDiv;
+        }
+    }
+    if ( !exact.empty() ) {
+        for ( unsigned int i = 0; i < m; i++ ) {
+            for ( unsigned int j = 0; j < n; j++ ) {
+                exact.at( ( i*n + j ) * angleDiv + ind ) += weightMatrix.at(i).at(j);
+            }
+        }
+    }
+    photons++;
+}
+
+/* Whether the tally holds block photons and has to be flushed */
+bool FloatTally::full() const {
+    return photons >= block;
+}
+
+/* Adds the tally into the double tally ars and clears it */
+void FloatTally::flush( vector<vector<vector<double> > >& ars ) {
+    unsigned int k = 0;
+    for ( unsigned int i = 0; i < m; i++ ) {
+        for ( unsigned int j = 0; j < n; j++ ) {
+            vector<double>& bins = ars.at(i).at(j);
+            for ( unsigned int a = 0; a < angleDiv; a++ ) {
+                bins[a] += sum[k];
+                sum[k++] = 0;
+            }
+        }
+    }
+    photons = 0;
+}
+
+/* Adds the double tally of the check flag into ars and clears it */
+void FloatTally::flushExact( vector<vector<vector<double> > >& ars ) {
+    for ( unsigned int k = 0; k < exact.size(); k++ ) {
+        ars.at( k / ( n * angleDiv ) ).at( ( k / angleDiv ) % n ).at( k % angleDiv ) += exact.at(k);
+        exact.at(k) = 0;
+    }
+}
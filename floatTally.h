@@ -0,0 +1,21 @@
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+#pragma once
+
+class FloatTally {
+    public:
+    FloatTally();
+    FloatTally( unsigned int, unsigned int, unsigned int, unsigned int, bool );
+    void add( const vector<vector<double> >&, unsigned int );
+    bool full() const;
+    void flush( vector<vector<vector<double> > >& );
+    void flushExact( vector<vector<vector<double> > >& );
+
+    private:
+    vector<float> sum;
+    vector<double> exact;
+    unsigned int m, n, angleDiv, block, photons;
+};
@@ -0,0 +1,152 @@
+#include "forwardPoint.h"
+
+/* ForwardPoint is the plain forward Monte Carlo model (as in MCMLpar) at a single point:
+the mut and etaa at the center of the search grid of each layer of setup, with the
+particles, detector radius and number of angles of setup. It sends the photons of each
+stream in parallel like a forward run of inverse, but without the search grid: the
+particles are simulated at the point itself, so their importance sampling weight there is
+one, and detect adds the scalar weight wScale alone to an ARS of each stream, without the
+weight vectors and the weight matrix. The photons are the same as those of a forward run
+of inverse with the same streams over the grid of that one point, and so is the ARS. The
+ARS is converted by fixARS, and the specular reflectance, the diffuse reflectance and
+transmittance (the weight that escapes up and down), and the absorbed rest are returned
+per photon sent, with the time of the run. In the MPI build, the ranks share the photons.
+Returns FALSE if there is an error. */
+
+/* Variables:
+    setup: The material, search grid, particles, radius and angles of the run
+    result: The ARS and the totals of the run
+    T: Specular transmission, particles that initially make it into the medium
+    pointMut, pointEtaa: The mut and etaa of each layer at the point
+    tally: The ARS of each stream at angleDiv, and its reflected and transmitted weights
+        after it
+    perProc, numRanks: Photons of each stream, and processes that share the photons
+*/
+
+/******************************************************************************/
+
+#ifdef SPRNGFIVE
+bool forwardPoint( InverseSetup& setup, Sprng** sprngptrarr, PointResult& result ) {
+#else
+bool forwardPoint( InverseSetup& setup, int** sprngptrarr, PointResult& result ) {
+#endif
+    vector<Layer>& layerVec = setup.layerVec;
+    unsigned int numProc = setup.numProc;
+    unsigned int numRanks = Ranks::size();
+    unsigned int angleDiv = 2 * setup.expData.size();
+    double radius = setup.radius;
+    double wall0 = omp_get_wtime();
+    Layer layAir;
+
+    bool complete = ( angleDiv > 0 ) && ( setup.numParticles > 0 ) && ( numProc > 0 ) &&
+        ( setup.mutVec.size() == layerVec.size() ) && ( setup.etaaVec.size() == layerVec.size() );
+    for ( unsigned int l = 0; l < layerVec.size() && complete; l++ ) {
+        complete = ( setup.mutVec.at(l).size() > 0 ) && ( setup.etaaVec.at(l).size() > 0 );
+    }
+    if ( !complete ) {
+        cerr << "Error: the forward run needs angles, particles and a search grid for every layer "
+            << "(in forwardPoint.cpp)." << endl;
+        return false;
+    }
+
+    /* Simulate at the center of the grid of each layer */
+    vector<vector<double> > pointMut( layerVec.size() ), pointEtaa( layerVec.size() );
+    for ( unsigned int l = 0; l < layerVec.size(); l++ ) {
+        pointMut.at(l).assign( 1, setup.mutVec.at(l).at( setup.mutVec.at(l).size()/2 ) );
+        pointEtaa.at(l).assign( 1, setup.etaaVec.at(l).at( setup.etaaVec.at(l).size()/2 ) );
+        layerVec.at(l).setMua( pointMut.at(l).at(0) * pointEtaa.at(l).at(0) );
+        layerVec.at(l).setMus( pointMut.at(l).at(0) - layerVec.at(l).getMua() );
+    }
+    double T = 1 - specularR( layerVec.at(0) );
+    Layer *layPtr = &layerVec.at(0);
+
+    unsigned int perProc = setup.numParticles / ( numProc * numRanks );
+    vector<vector<vector<double> > > tally( numProc, vector<vector<double> >( 1, vector<double>( angleDiv + 2, 0 ) ) );
+    omp_set_num_threads( numProc );
+
+    #pragma omp parallel for
+    for ( unsigned int n = 0; n < numProc; n++ ) {
+        Particle par( T, pointMut, pointEtaa, sprngptrarr[n] );
+        par.weight.setReference( layerVec );
+        vector<double>& ars = tally.at(n).at(0);
+        int state;
+        int propagate( Particle& );
+        int detect( Particle&, double, unsigned int, vector<double>& );
+        int scatter( Particle& );
+        int boundary( Particle&, Layer&, vector<Layer>& );
+
+        for ( unsigned int i = 0; i < perProc; i++ ) {
+            par.reset( T );
+            par.lay = *layPtr;
+            state = 2;
+            while ( state ) {
+                switch( state ) {
+                case 1:
+                    state = scatter( par );
+                    break;
+
+                case 2:
+                    state = propagate( par );
+                    break;
+
+                case 3:
+                    state = boundary( par, layAir, layerVec );
+                    break;
+
+                case 4:
+                    ars.at( ( par.dir.at(2) < 0 ) ? angleDiv : angleDiv + 1 ) += par.weight.wScale;
+                    state = detect( par, radius, angleDiv, ars );
+                    break;
+                }
+            }
+        }
+    }
+
+    /* Add up the streams, in order, and the ranks */
+    for ( unsigned int n = 1; n < numProc; n++ ) {
+        for ( unsigned int k = 0; k < angleDiv + 2; k++ ) {
+            tally.at(0).at(0).at(k) += tally.at(n).at(0).at(k);
+        }
+    }
+    tally.resize( 1 );
+    Ranks::reduce( tally );
+
+    result.photons = (unsigned long long) perProc * numProc * numRanks;
+    result.specular = 1 - T;
+    result.reflected = tally.at(0).at(0).at( angleDiv ) / result.photons;
+    result.transmitted = tally.at(0).at(0).at( angleDiv + 1 ) / result.photons;
+    result.absorbed = T - result.reflected - result.transmitted;
+    tally.at(0).at(0).resize( angleDiv );
+    fixARS( tally, result.photons, 1, 1 );
+    result.ars = tally.at(0).at(0);
+    result.mut.resize( layerVec.size() );
+    result.etaa.resize( layerVec.size() );
+    for ( unsigned int l = 0; l < layerVec.size(); l++ ) {
+        result.mut.at(l) = pointMut.at(l).at(0);
+        result.etaa.at(l) = pointEtaa.at(l).at(0);
+    }
+    result.seconds = omp_get_wtime() - wall0;
+    return true;
+}
+
+/* Writes the point, the totals and the ARS (one central angle per row, as in exp.txt) to
+path as CSV. Returns FALSE if the file did not open. */
+bool PointResult::write( const string& path ) const {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from forwardPoint.cpp)." << endl;
+        return false;
+    }
+    saveData << setprecision( 10 );
+    for ( unsigned int l = 0; l < mut.size(); l++ ) {
+        saveData << "mu_t " << l+1 << "," << mut.at(l) << endl << "eta_a " << l+1 << "," << etaa.at(l) << endl;
+    }
+    saveData << "photons," << photons << endl << "seconds," << seconds << endl << "photons per second,"
+        << photons / seconds << endl << "specular reflectance," << specular << endl << "diffuse reflectance,"
+        << reflected << endl << "transmittance," << transmitted << endl << "absorbed," << absorbed << endl;
+    saveData << "angle,ARS" << endl;
+    for ( unsigned int k = 0; k < ars.size(); k++ ) {
+        saveData << 180.0 * k / ars.size() << "," << ars.at(k) << endl;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#include "boundary.h"
+#include "detect.h"
+#include "fixARS.h"
+#include "inverse.h"
+#include "layer.h"
+#include "particle.h"
+#include "propagate.h"
+#include "ranks.h"
+#include "scatter.h"
+#include "specularR.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include "omp.h"
+
+#ifdef SPRNGFIVE
+#include "sprng_cpp.h"
+#endif
+
+using namespace std;
+
+#pragma once
+
+struct PointResult {
+    vector<double> ars, mut, etaa;
+    double specular, reflected, transmitted, absorbed, seconds;
+    unsigned long long photons;
+    bool write( const string& ) const;
+};
+
+#ifdef SPRNGFIVE
+bool forwardPoint( InverseSetup&, Sprng**, PointResult& );
+#else
+bool forwardPoint( InverseSetup&, int**, PointResult& );
+#endif
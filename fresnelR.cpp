@@ -0,0 +1,41 @@
+#include "fresnelR.h"
+
+/* FresnelR calculates the unpolarized Fresnel reflectance for a particle moving
+from a medium of index n1 into a medium of index n2 with z-direction kz1. It also
+sets kz2, the z-direction the particle would have if it were transmitted. FresnelR
+is called by medInterface and by the refractive index weights. It assumes a
+non-magnetic medium. */
+
+/* Variables:
+    kz1, kz2: z-component of direction vector originally and if transmitted
+    n1, n2: indices of refraction of current and potential medium
+    Rp: reflectance for P-polarized light
+    Rs: reflectance for S-polarized light */
+
+/********************************************************************/
+
+double fresnelR( double n1, double n2, double kz1, double& kz2 ) {
+    double storeCalc, Rp, Rs;
+
+	/* Non-TIR case: set up Fresnel Coefficients. Use Snell's law to find kz2. */
+	storeCalc = n1*n1 * ( 1-kz1*kz1 ) / ( n2*n2 );
+	if ( storeCalc <= 1 ) {
+
+        /* If-else statement makes sure that kz1 & kz2 have the same sign */
+        if ( kz1 > 0 ) {
+            kz2 = sqrt( 1-storeCalc );
+        }
+        else {
+            kz2 = -sqrt( 1-storeCalc );
+        }
+
+        /* Fresnel's equations */
+        Rs = pow( ( ( n1*kz1 - n2*kz2 ) / ( n1*kz1 + n2*kz2 ) ), 2 );
+        Rp = pow( ( ( n2*kz1 - n1*kz2 ) / ( n2*kz1 + n1*kz2 ) ), 2 );
+        return ( 1.0/2.0 ) * ( Rp + Rs );
+	}
+
+	/* TIR case- particle must reflect */
+    kz2 = -kz1;
+    return 1;
+}
@@ -0,0 +1,7 @@
+#include <math.h>
+
+using namespace std;
+
+#pragma once
+
+double fresnelR( double, double, double, double& );
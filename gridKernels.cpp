@@ -0,0 +1,82 @@
+#include "gridKernels.h"
+
+/* GridKernels are the tally kernels of detect: they evaluate the importance sampling
+weights of a detected photon over the search grid and add them to the ARS at its angle
+index. tallyGeneric does it for any grid, with Weight::updateMatrix. tallyFixed is the
+same kernel for a single layer with a grid of M mut by N etaa values known at compile time:
+the weight vectors are kept in std::array on the stack instead of the vectors of Weight,
+and the loops have fixed trip counts without bounds checks, so the compiler unrolls them
+and vectorizes the products. The arithmetic is the same as that of the generic kernel, so
+the ARS is too. The common grid shapes are instantiated in SHAPES, and tallyKernel picks
+the one of a run, or the generic kernel for any other shape or more than one layer, once
+per chunk of photons (see inverse.cpp). */
+
+/* Variables:
+    weight: The counts and scalar weight of the photon, and the grid and references
+    ars: The ARS tally of the grid (mut, etaa, angle)
+    ind: The angle index of the photon
+    mutW, etaaW: The mut and etaa weight vectors of the photon
+*/
+
+/******************************************************************************/
+
+void tallyGeneric( Weight& weight, vector<vector<vector<double> > >& ars, unsigned int ind ) {
+    weight.updateMatrix();
+    for ( unsigned int i = 0; i < weight.weightMut.size(); i++ ) {
+        for ( unsigned int j = 0; j < weight.weightEtaa.size(); j++ ) {
+            ars.at(i).at(j).at(ind) += weight.weightMatrix.at(i).at(j);
+        }
+    }
+}
+
+template <unsigned int M, unsigned int N>
+static void tallyFixed( Weight& weight, vector<vector<vector<double> > >& ars, unsigned int ind ) {
+    array<double, M> mutW;
+    array<double, N> etaaW;
+    const double* mutVal = &weight.mutVec[0][0];
+    const double* etaaVal = &weight.etaaVec[0][0];
+    double mut0 = weight.mutRef[0], etaa1 = 1 - weight.etaaRef[0];
+    double k = weight.numColl[0], t = weight.pathLen[0], wScale = weight.wScale;
+
+    for ( unsigned int b = 0; b < M; b++ ) {
+        mutW[b] = pow( mutVal[b] / mut0, k ) * exp( t * ( mut0 - mutVal[b] ) );
+    }
+    for ( unsigned int b = 0; b < N; b++ ) {
+        etaaW[b] = pow( ( 1 - etaaVal[b] ) / etaa1, k );
+    }
+
+    /* The products of a row are independent, and only their sums go through the vectors
+    of the tally */
+    for ( unsigned int i = 0; i < M; i++ ) {
+        array<double, N> row;
+        for ( unsigned int j = 0; j < N; j++ ) {
+            row[j] = mutW[i] * etaaW[j] * wScale;
+        }
+        vector<vector<double> >& arsRow = ars[i];
+        for ( unsigned int j = 0; j < N; j++ ) {
+            arsRow[j][ind] += row[j];
+        }
+    }
+}
+
+/* The grid shapes (mut by etaa) with a kernel of their own */
+#define SHAPES \
+    SHAPE( 1, 1 ) \
+    SHAPE( 17, 15 ) \
+    SHAPE( 15, 17 ) \
+    SHAPE( 31, 31 ) \
+    SHAPE( 63, 63 )
+
+/* Returns the kernel for a grid of m by n values over layers layers */
+TallyKernel tallyKernel( unsigned int m, unsigned int n, unsigned int layers ) {
+    if ( layers != 1 ) {
+        return tallyGeneric;
+    }
+#define SHAPE( M, N ) \
+    if ( ( m == M ) && ( n == N ) ) { \
+        return tallyFixed<M, N>; \
+    }
+    SHAPES
+#undef SHAPE
+    return tallyGeneric;
+}
@@ -0,0 +1,13 @@
+#include "weight.h"
+#include <vector>
+#include <array>
+#include <math.h>
+
+using namespace std;
+
+#pragma once
+
+typedef void (*TallyKernel)( Weight&, vector<vector<vector<double> > >&, unsigned int );
+
+void tallyGeneric( Weight&, vector<vector<vector<double> > >&, unsigned int );
+TallyKernel tallyKernel( unsigned int, unsigned int, unsigned int );
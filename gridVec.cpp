@@ -0,0 +1,16 @@
+#include "gridVec.h"
+
+/* GridVec returns size values evenly spaced from low to high, both included, the way the
+search grid of each layer is made from the input file. A grid of one value is low. The
+input file, the requests of the daemon and sweep, the batch and library fits when they
+move their grid, the benchmarks and tools/rebinLog all make their grids with it. */
+
+/******************************************************************************/
+
+vector<double> gridVec( double low, double high, unsigned int size ) {
+    vector<double> values( size, low );
+    for ( unsigned int i = 1; i < size; i++ ) {
+        values.at(i) = low + i * ( high - low ) / ( size - 1 );
+    }
+    return values;
+}
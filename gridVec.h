@@ -0,0 +1,7 @@
+#include <vector>
+
+using namespace std;
+
+#pragma once
+
+vector<double> gridVec( double, double, unsigned int );
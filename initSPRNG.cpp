@@ -2,7 +2,8 @@
 
 /* Written by Richelle Streater, June 2017. */
 
-/* initSPRNG initializes and seeds the parallel random number generator.
+/* initSPRNG initializes and seeds the parallel random number generator. Each rank of
+an MPI run spawns its streams from a stream of its own.
 initSPRNG returns false if the streams have not been spawned and true if
 they have. */
 
@@ -15,7 +16,7 @@ unsigned int numSpawned;
 #else
 bool initSPRNG( unsigned int numProc, int ***sprngptrarr, int time_0 ) {
     int *stream;
-    stream = init_sprng( SPRNG_LCG64, 0, 1, time_0, SPRNG_DEFAULT );
+    stream = init_sprng( SPRNG_LCG64, Ranks::rank(), Ranks::size(), time_0, SPRNG_DEFAULT );
 
     unsigned int numSpawned = spawn_sprng( stream, numProc, sprngptrarr );
 
@@ -1,3 +1,4 @@
+#include "ranks.h"
 #include "sprng.h"
 #include <iostream>
 
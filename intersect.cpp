@@ -5,24 +5,29 @@
 /* Intersect solves for the polar angle on the detection sphere, accounting
 for finite radius. If intersect did not account for finite radius,
 it would only need to return arccos(par.rVec.at(2)). Intersect is called by
-detect. */
+detect. The second form takes a position and direction instead of a particle,
+so that detectN can find the angle for directions the particle did not take. */
 
 /******************************************************************************/
 
 double intersect( double R, Particle &par ) {
+    return intersect( R, par.rVec, par.dir );
+}
+
+double intersect( double R, vector<double>& rVec, const vector<double>& dir ) {
 
     /* Set the z component to zero because we assume that the center of the detection sphere
     is at this z-position, and we only are accounting for x and y position. */
-    par.rVec.at(2) = 0;
+    rVec.at(2) = 0;
 
 	/* Find alpha, the distance that the particle will travel until it intersects with the
 	sphere. The final position when the particle intersects is rVec = alpha*dir + rVec0. */
 	double alpha, x, rSquared = 0, theta;
-	x = dotProd( par.rVec, par.dir );
+	x = dotProd( rVec, dir );
 
 	/* Find the square of the magnitude of rVec */
-	for( unsigned int i=0; i < par.rVec.size(); i++ ) {
-		rSquared += par.rVec.at(i) * par.rVec.at(i);
+	for( unsigned int i=0; i < rVec.size(); i++ ) {
+		rSquared += rVec.at(i) * rVec.at(i);
 	}
 
 	double arg = x*x + R*R - rSquared;
@@ -33,18 +38,18 @@ double intersect( double R, Particle &par ) {
 	alpha = -x + sqrt( arg );
 
     /* Update position so that particle is on the detector sphere */
-    for ( unsigned int i = 0; i < par.rVec.size(); i++ ) {
-        par.rVec.at(i) += alpha * par.dir.at(i);
+    for ( unsigned int i = 0; i < rVec.size(); i++ ) {
+        rVec.at(i) += alpha * dir.at(i);
     }
 
-    double aTanArg = par.rVec.at(0)*par.rVec.at(0)
-           + par.rVec.at(1)*par.rVec.at(1);
+    double aTanArg = rVec.at(0)*rVec.at(0)
+           + rVec.at(1)*rVec.at(1);
     if ( aTanArg < 0 ) {
         aTanArg = 0;
     }
 
 	/* Obtain point of intersection: atan2(rho, z), since x^2+y^2 = rho */
-	theta = atan2( sqrt( aTanArg ), par.rVec.at(2) );
+	theta = atan2( sqrt( aTanArg ), rVec.at(2) );
 
 	return theta;
 }
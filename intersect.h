@@ -8,3 +8,4 @@ using namespace std;
 #pragma once
 
 double intersect( double, Particle& );
+double intersect( double, vector<double>&, const vector<double>& );
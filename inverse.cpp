@@ -0,0 +1,917 @@
+#include "inverse.h"
+
+/* Inverse runs the inverse algorithm for one experimental curve, or one batch of curves,
+with the material, search grid and options of setup, and the random number streams of
+main. It zeros out the ars vectors (the solutions to the forward MC simulation) and sets
+the reference importance sampling mua and mus values to the median of the mut and etaa
+vectors. It declares functions within the parallel for loop to eliminate race conditions.
+Next, it runs the forward MC simulation on all particles, cycling between four states:
+scatter, propagate, boundary, and detect, until the particle escapes or vanishes in the
+material. It updates the search interval, doubles number of particles, and repeats again.
+For a multi-layer material, the grid is over every combination of the layers' parameters,
+and the search interval of each layer is updated from its profile likelihood.
+
+The options of setup (see runOptions.cpp) change how the forward runs are split up and
+tallied, and what the control loop does with them. Each is described where it is done:
+the n scan in profileIndex.cpp, trustRegion in trustRegion.cpp, adaptive in
+adaptiveBudget.cpp, batch in curveBatch.cpp, the library options in arsLibrary.cpp and
+reducedArs.cpp, checkpoint in checkpoint.cpp, the MPI build in ranks.cpp, the
+COUNT_EVENTS build in eventCounters.cpp, the timing and trace option in phaseTimer.cpp,
+and how the escaping photons are tallied (floatTally, gridTiles, pipeline and escapeLog)
+in escapeTally.cpp. The sequential and timeBudget options end an iteration, or the run,
+after any round of its forward run.
+
+The progress of the run is printed to setup.progress. Inverse returns FALSE if there is
+an error, and says what failed in result.error. The results are in result, or in the
+curve batch of setup for the batch option, and result.fit is FALSE if no fit was made
+(buildLibrary option). If setup.forwardOnly is set, inverse stops after the first forward
+run and moves its ARS over the search grid into result.ars, where the caller can use the
+tallies without a copy. */
+
+/* Variables:
+    setup: The material, search grid, experimental ARS and options of the run
+    progress: The stream to print the progress of the run to, cout unless the caller has one
+        for each run (e.g. sweep)
+    result: The contour parameters of each layer, the n grid scan, the lines to report
+        why the run stopped with, the ARS of a forward only run, and why the run failed
+    numParticles: Number of particles to send through medium (forward MC simulation)
+    numIter: Number of times to resize the search box (inverse)
+    numProc: Number of processors to use (parallelization)
+    radius: Radius of detector
+    layerVec: Vector holding parameters for all layers in the material
+    mutVec, etaaVec: List of mut's and etaa's of each layer to search over (mut = mua+mus,
+        etaa = mua/mut)
+    mutSize, etaaSize: Number of mut and etaa combinations over all layers
+    expData: List of experimental angle resolved scattering results
+    angleDiv: Number of divisions of ARS to measure
+    T: Specular transmission, particles that initially make it into the medium
+    ars, arsProc: Store the angle resolved scattering results (forward MC simulation)
+    likGrid: The likelihood values for each point in the grid of mut and etaa
+    layerGrid: The profile likelihood values over the mut and etaa of one layer
+    paramOut: The contour parameters of each layer
+    options: Optional settings from the input file
+    arsN, arsNProc: The ARS results reweighted to each index in the n grid (last iteration)
+    nProfile, nFit: The profile log-likelihood of each index in the n grid, and the fitted n
+    trust: The trust region optimizer (trustRegion option)
+    deriv, derivProc: The ARS and its derivatives at the trial point of the optimizer
+    budget: Picks the particles of each iteration and checks for convergence (adaptive option)
+    numBatch: Number of batches of the forward run, at least 8 in an adaptive run
+    numTally: Number of separate ARS tallies in arsProc, one for each batch or one shared by
+        all threads (gridTiles option)
+    tiled, tiles: Whether the threads share one tally, and its buffer of escape records
+        (gridTiles option)
+    pipelined, numFeed, rings: Whether the threads are split into transport and tally threads,
+        the number of transport threads, and the ring buffer of each (pipeline option)
+    escapeLog: The log of the escaping photons of the current forward run (escapeLog option)
+    stopReason, report: Why the control loop stopped, and the lines to report it with
+    wall0, outOfTime: Wall-clock start of the run, and whether its time budget ran out
+    numRounds, perBatch: Rounds of each forward run, and particles per batch of each rank in
+        each round
+    numRanks: Number of processes that share the particles (MPI build)
+    numDone: Particles sent in the current iteration so far, by all ranks
+    saved, numSlices: The state of the run at the last checkpoint, and the slices of each round
+        (checkpoint option)
+    startIter, resuming: The iteration to start with, and whether the run goes on from saved
+    sliceStart, sliceEnd: The particles of each batch in the current slice
+    timer: The wall and CPU time of each phase of each iteration, and the timeline of every
+        thread (trace option)
+    batchStart: Start of the photons of a batch on the timeline
+    tally: Where the escaping photons of the forward run are tallied, for the options of the
+        run
+    floatProc, arsCheck, likCheck: The single precision ARS tally of each stream, and the ARS
+        and log-likelihood grid of the same photons in double precision (floatTally option)
+    countProc, events: The transport events of each stream, and of all of them in each iteration
+        (COUNT_EVENTS build)
+    curveBatch: The experimental curves of a batch, and their results (batch option)
+    reduced: The ARS over the grid compressed to a few basis curves (reducedBasis option)
+    box, lastBox, settled: Search region after this and the last round, and the number of
+        rounds in a row it stayed the same (sequential option)
+*/
+
+/******************************************************************************/
+
+/* The default setup is a single layer with an empty search grid and no experimental
+data, which the caller fills in */
+InverseSetup::InverseSetup() {
+    layerVec.assign( 1, Layer() );
+    mutVec.assign( 1, vector<double>() );
+    etaaVec.assign( 1, vector<double>() );
+    expData.clear();
+    numParticles = 20000;
+    numIter = 7;
+    numProc = 1;
+    radius = 1e6;
+    forwardOnly = false;
+    progress = &cout;
+}
+
+#ifdef SPRNGFIVE
+bool inverse( InverseSetup& setup, Sprng** sprngptrarr, InverseResult& result ) {
+#else
+bool inverse( InverseSetup& setup, int** sprngptrarr, InverseResult& result ) {
+#endif
+
+    /* Work on the inputs of setup under their usual names */
+    vector<Layer>& layerVec = setup.layerVec;
+    vector<vector<double> >& mutVec = setup.mutVec;
+    vector<vector<double> >& etaaVec = setup.etaaVec;
+    vector<double>& expData = setup.expData;
+    unsigned int numParticles = setup.numParticles;
+    unsigned int numIter = setup.forwardOnly ? 1 : setup.numIter;
+    unsigned int numProc = setup.numProc;
+    double radius = setup.radius;
+    RunOptions& options = setup.options;
+    CurveBatch& curveBatch = setup.curveBatch;
+    ostream& progress = *setup.progress;
+    bool batchMode = ( options.batchPath.size() > 0 );
+    double wall0 = omp_get_wtime();
+    Layer layAir;
+    ReducedArs reduced;
+    result.fit = false;
+    result.error.clear();
+    PhaseTimer& timer = result.timing;
+    timer = PhaseTimer();
+    vector<EventCounters>& events = result.events;
+    events.clear();
+
+    /* A setup that was not read by setParameters may be incomplete */
+    bool complete = ( expData.size() > 0 ) && ( numParticles > 0 ) && ( numIter > 0 ) &&
+        ( mutVec.size() == layerVec.size() ) && ( etaaVec.size() == layerVec.size() );
+    for ( unsigned int l = 0; l < layerVec.size() && complete; l++ ) {
+        complete = ( mutVec.at(l).size() > 0 ) && ( etaaVec.at(l).size() > 0 );
+    }
+    if ( !complete ) {
+        result.error = "the setup needs experimental data, particles, iterations and a search grid for every layer";
+        cerr << "Error: " << result.error << " (in inverse.cpp)." << endl;
+        return false;
+    }
+
+    /* Initialize variables */
+
+    /* The trust region optimizer starts at the center of the search region, and its grid
+    is only the incumbent point */
+    bool newton = ( options.trustRadius > 0 ) && !setup.forwardOnly;
+    TrustRegion trust;
+    if ( newton ) {
+        trust = TrustRegion( etaaVec.at(0).at( etaaVec.at(0).size()/2 ), mutVec.at(0).at( mutVec.at(0).size()/2 ),
+            etaaVec.at(0).back() - etaaVec.at(0).front(), mutVec.at(0).back() - mutVec.at(0).front(),
+            options.trustRadius );
+        etaaVec.at(0).assign( 1, trust.etaaInc );
+        mutVec.at(0).assign( 1, trust.mutInc );
+    }
+
+    /* An adaptive run needs enough batches to estimate the noise from */
+    bool adaptive = ( options.adaptTol > 0 );
+    AdaptiveBudget budget( options.adaptTol, options.contourTol, options.noiseTarget,
+        options.maxParticles );
+    unsigned int numBatch = numProc;
+    if ( adaptive && numBatch < 8 ) {
+        numBatch = 8;
+    }
+    bool tiled = ( options.tileRecords > 0 );
+    unsigned int numTally = tiled ? 1 : numBatch;
+    if ( tiled && ( adaptive || ( options.floatBlock > 0 ) || omp_in_parallel() ) ) {
+        result.error = "gridTiles needs no adaptive, floatTally or sweep";
+        cerr << "Error: " << result.error << " (in inverse.cpp)." << endl;
+        return false;
+    }
+    bool pipelined = ( options.pipeTally > 0 );
+    unsigned int numFeed = pipelined ? numProc - options.pipeTally : numProc;
+    if ( pipelined && ( ( options.pipeTally >= numProc ) || tiled || ( options.floatBlock > 0 ) || omp_in_parallel() ) ) {
+        result.error = "pipeline needs fewer tally threads than processors and no gridTiles, floatTally or sweep";
+        cerr << "Error: " << result.error << " (in inverse.cpp)." << endl;
+        return false;
+    }
+    string stopReason = "iteration limit reached";
+    bool outOfTime = false;
+    unsigned int numRounds = options.rounds;
+    unsigned int numRanks = Ranks::size();
+    vector<string>& report = result.report;
+    report.clear();
+
+    /* Doubles, ints, and chars */
+    unsigned int angleDiv = 2 * ( expData.size() );
+    unsigned int mutSize = 1, etaaSize = 1;
+    for ( unsigned int l = 0; l < layerVec.size(); l++ ) {
+        mutSize *= mutVec.at(l).size();
+        etaaSize *= etaaVec.at(l).size();
+    }
+    double T = 1 - specularR( layerVec.at(0) );
+
+    /* Initialize vectors that need earlier information */
+    omp_set_num_threads( numProc );
+    if ( options.tracePath.size() > 0 ) {
+        timer.timeline.start();
+    }
+    vector<vector<vector<double> > > arsInitial( mutSize, vector<vector<double> >
+        ( etaaSize, vector<double>( angleDiv, 0 ) ) ), ars;
+    vector<vector<vector<vector<double> > > > arsProcInitial( numTally, vector<vector<vector<double> > >
+        ( mutSize, vector<vector<double> >( etaaSize, vector<double>( angleDiv, 0 ) ) ) ), arsProc;
+    vector<vector<double> >& paramOut = result.paramOut;
+    paramOut.assign( layerVec.size(), vector<double>(5, 0) );
+    vector<vector<double> > likGrid( mutSize, vector<double>( etaaSize, 0 ) ), layerGrid;
+    vector<vector<vector<vector<double> > > > arsN;
+    vector<vector<vector<vector<vector<double> > > > > arsNProc;
+    vector<double>& nProfile = result.nProfile;
+    vector<double>& nFit = result.nFit;
+    nProfile.clear();
+    nFit.clear();
+    vector<vector<vector<double> > > derivInitial( 6, vector<vector<double> >( 1, vector<double>( angleDiv, 0 ) ) ), deriv;
+    vector<vector<vector<vector<double> > > > derivProc;
+    TiledTally tiles;
+    if ( tiled ) {
+        tiles = TiledTally( mutSize, etaaSize, angleDiv, layerVec.size(), numProc, options.tileRecords );
+    }
+    EscapeLog escapeLog;
+    vector<EscapeRing> rings( pipelined ? numFeed : 0 );
+    for ( unsigned int p = 0; p < rings.size(); p++ ) {
+        rings.at(p).init( options.pipeCapacity, layerVec.size() );
+    }
+
+    Layer *layPtr;
+    layPtr = &layerVec.at(0);
+
+/**************************  End of initialization  ***************************/
+
+/*************************  Library from sub-grids  ***************************/
+
+    /* Write a library instead of fitting. Each of the libraryBlocks by libraryBlocks sub-grids
+    is a forward only run of libraryParticles particles, with the reference mut and etaa at its
+    own center, so that no grid point is importance sampled from far away. */
+    if ( ( options.buildLibrary.size() > 0 ) && !setup.forwardOnly ) {
+        unsigned int blocks = options.libraryBlocks;
+        ars = arsInitial;
+        for ( unsigned int bi = 0; bi < blocks; bi++ ) {
+            for ( unsigned int bj = 0; bj < blocks; bj++ ) {
+                unsigned int i0 = bi * mutSize / blocks, i1 = ( bi+1 ) * mutSize / blocks;
+                unsigned int j0 = bj * etaaSize / blocks, j1 = ( bj+1 ) * etaaSize / blocks;
+                if ( ( i0 == i1 ) || ( j0 == j1 ) ) {
+                    continue;
+                }
+                InverseSetup sub = setup;
+                sub.options.buildLibrary.clear();
+                sub.numParticles = options.libraryParticles;
+                sub.forwardOnly = true;
+                sub.mutVec.at(0).assign( mutVec.at(0).begin() + i0, mutVec.at(0).begin() + i1 );
+                sub.etaaVec.at(0).assign( etaaVec.at(0).begin() + j0, etaaVec.at(0).begin() + j1 );
+                InverseResult subResult;
+                if ( !inverse( sub, sprngptrarr, subResult ) ) {
+                    result.error = subResult.error;
+                    return false;
+                }
+                for ( unsigned int i = i0; i < i1; i++ ) {
+                    for ( unsigned int j = j0; j < j1; j++ ) {
+                        ars.at(i).at(j).swap( subResult.ars.at( i-i0 ).at( j-j0 ) );
+                    }
+                }
+            }
+        }
+        if ( options.reducedRank > 0 ) {
+            reduced.build( ars, mutSize, etaaSize, options.reducedRank, progress );
+        }
+        if ( ( Ranks::rank() == 0 ) && !ArsLibrary::write( options.buildLibrary, layerVec.at(0), radius,
+            options.libraryParticles, mutVec.at(0), etaaVec.at(0), ars, reduced ) ) {
+            result.error = "the library could not be written";
+            return false;
+        }
+        progress << "Library written to " << options.buildLibrary << " (" << blocks << " by " << blocks
+            << " sub-grids of " << options.libraryParticles << " particles)" << endl;
+        return true;
+    }
+
+/************************  Inverse from a library  ****************************/
+
+    /* Fit by interpolating the ARS of a library instead of running the forward model */
+    if ( ( options.fitLibrary.size() > 0 ) && !setup.forwardOnly ) {
+        ArsLibrary library;
+        if ( !library.open( options.fitLibrary ) || !library.matches( layerVec.at(0), radius, expData.size() ) ) {
+            result.error = "the library could not be read, or does not match the setup";
+            return false;
+        }
+        progress << "Library " << options.fitLibrary << ": " << library.header.mutSize << " mu_t by "
+            << library.header.etaaSize << " eta_a, " << library.header.numParticles << " particles";
+        if ( library.header.rank > 0 ) {
+            progress << ", reduced to " << library.header.rank << " basis curves";
+        }
+        progress << endl;
+
+        /* A reduced library is scored from the interpolated coefficients */
+        if ( library.header.rank > 0 ) {
+            library.reducedBasis( reduced );
+        }
+        for ( unsigned int a = 0; a < numIter; a++ ) {
+            if ( !library.clampGrid( mutVec.at(0), etaaVec.at(0) ) ) {
+                result.error = "the search grid does not overlap the library";
+                return false;
+            }
+            if ( reduced.rank > 0 ) {
+                library.interpolate( mutVec.at(0), etaaVec.at(0), reduced.coeffs );
+                if ( !reduced.score( likGrid, expData ) ) {
+                    result.error = "the ARS could not be scored";
+                    return false;
+                }
+            }
+            else {
+                library.interpolate( mutVec.at(0), etaaVec.at(0), ars );
+                if ( !scoreParam( ars, likGrid, expData, mutSize, etaaSize ) ) {
+                    result.error = "the ARS could not be scored";
+                    return false;
+                }
+            }
+            subFromMax( likGrid, mutSize, etaaSize );
+            if ( !updateInterval( likGrid, paramOut.at(0), mutVec.at(0), etaaVec.at(0), a==(numIter-1),
+                progress ) ) {
+                result.error = "the search region could not be updated";
+                return false;
+            }
+        }
+
+        progress << "Fit from library in " << setprecision( 3 ) << 1000 * ( omp_get_wtime() - wall0 )
+            << " ms" << endl;
+        result.fit = true;
+        return true;
+    }
+
+/****************************  Inverse algorithm  *****************************/
+
+    /* Go on from the checkpoint of a run that was stopped (resume option). The shape of the run
+    must be the same as when it was saved. */
+    bool checkpointing = ( options.checkpointPath.size() > 0 );
+    unsigned int numSlices = checkpointing ? 32 : 1;
+    Checkpoint saved;
+    unsigned int shape[] = { numProc, numTally, (unsigned int) layerVec.size(), angleDiv, mutSize,
+        etaaSize, numRounds, numSlices, numIter, numRanks };
+    saved.shape.assign( shape, shape + sizeof( shape ) / sizeof( shape[0] ) );
+    unsigned int startIter = 0;
+    bool resuming = false;
+    if ( checkpointing && options.resume ) {
+        if ( !saved.read( options.checkpointPath, sprngptrarr, numProc ) ) {
+            result.error = "the checkpoint could not be read";
+            return false;
+        }
+        resuming = true;
+        startIter = saved.iter;
+        numParticles = saved.numParticles;
+        mutVec = saved.mutVec;
+        etaaVec = saved.etaaVec;
+        paramOut = saved.paramOut;
+        wall0 -= saved.elapsed;
+        progress << "Resuming at iteration " << saved.iter+1 << ", round " << saved.round+1 << ", slice "
+            << saved.slice << " of " << numSlices << endl;
+    }
+    double lastCheckpoint = omp_get_wtime();
+
+    /* Control loop for inverse: resets bounding box and doubles particles each time. */
+    unsigned int a, numDone = 0;
+    for ( a = startIter; a < numIter; a++ ) {
+        timer.nextIteration( numDone );
+        arsProc = resuming ? saved.arsProc : arsProcInitial;
+        for ( unsigned int l = 0; l < layerVec.size(); l++ ) {
+            layerVec.at(l).setMua( mutVec.at(l).at( mutVec.at(l).size()/2 ) * etaaVec.at(l).at( etaaVec.at(l).size()/2 ) );
+            layerVec.at(l).setMus( mutVec.at(l).at( mutVec.at(l).size()/2 ) - layerVec.at(l).getMua() );
+        }
+
+        /* The optimizer simulates at its trial point instead */
+        if ( newton ) {
+            layerVec.at(0).setMua( trust.mutTrial * trust.etaaTrial );
+            layerVec.at(0).setMus( trust.mutTrial - layerVec.at(0).getMua() );
+            deriv = derivInitial;
+            derivProc.assign( numProc, derivInitial );
+        }
+
+        /* Each forward run replaces the log of the last one, so the log of the run that ends
+        the control loop is kept, whenever it stops */
+        if ( ( options.escapeLogPath.size() > 0 ) &&
+            !escapeLog.open( options.escapeLogPath, layerVec, radius, angleDiv, numProc ) ) {
+            result.error = "the escape log could not be opened";
+            return false;
+        }
+
+        /* Reweight the last forward run to the n grid, if there is one */
+        bool scanN = ( a == numIter-1 ) && ( options.nGrid.size() > 0 );
+        if ( scanN ) {
+            arsN.assign( options.nGrid.size(), arsInitial );
+            arsNProc.assign( numProc, arsN );
+            if ( resuming ) {
+                arsNProc = saved.arsNProc;
+            }
+        }
+
+/*********************  Forward Monte Carlo Simulation  ***********************/
+
+        /* Run the particles in rounds. With the sequential option, the search region is checked
+        after each round, and the iteration ends once it stays the same. The time budget is checked
+        after each round too. */
+        unsigned int perBatch = numParticles / ( numBatch * numRounds * numRanks );
+        unsigned int settled = 0, r0 = 0, s0 = 0, sliceStart = 0, sliceEnd = 0;
+        numDone = 0;
+        vector<int> box, lastBox;
+        vector<EventCounters> countProc( numProc );
+        vector<FloatTally> floatProc( ( options.floatBlock > 0 ) ? numProc : 0,
+            FloatTally( mutSize, etaaSize, angleDiv, options.floatBlock, options.floatCheck ) );
+        if ( resuming ) {
+            settled = saved.settled;
+            numDone = saved.numDone;
+            lastBox = saved.lastBox;
+            r0 = saved.round;
+            s0 = saved.slice;
+            resuming = false;
+        }
+
+        /* Where the escaping photons are tallied, for the options of the run */
+        EscapeTally tally( arsProc, radius, angleDiv, mutSize, etaaSize, layerVec.size() );
+        if ( escapeLog.on ) {
+            tally.log = &escapeLog;
+        }
+        if ( scanN ) {
+            tally.arsNProc = &arsNProc;
+            tally.nRef = layPtr->getN();
+        }
+        if ( newton ) {
+            tally.derivProc = &derivProc;
+        }
+        if ( floatProc.size() > 0 ) {
+            tally.floatProc = &floatProc;
+        }
+        if ( tiled ) {
+            tally.tiles = &tiles;
+        }
+        if ( pipelined ) {
+            tally.rings = &rings;
+        }
+
+        for ( unsigned int r = r0; r < numRounds; r++ ) {
+            double roundStart = omp_get_wtime();
+
+            /* The particles of stream n are one chunk of work */
+            auto chunk = [&]( unsigned int n ) {
+
+                /* Safe initializations within the parallel loop to eliminate race conditions */
+                Particle par( T, mutVec, etaaVec, sprngptrarr[n] );
+                par.weight.setReference( layerVec );
+                int state;
+                int propagate( Particle& );
+                int scatter( Particle& );
+                int boundary( Particle&, Layer&, vector<Layer>& );
+                if ( scanN ) {
+                    par.weight.setNGrid( options.nGrid, layPtr->getN() );
+                }
+
+                /* Send particle through the material, one batch of this thread at a time */
+                for ( unsigned int b = n; b < numBatch; b += numProc ) {
+                double batchStart = timer.timeline.on ? timer.timeline.now() : 0;
+                for ( unsigned int i = sliceStart; i < sliceEnd; i++ ) {
+
+                    /* Reset particle weight/position and put the particle in the first layer */
+                    par.reset( T );
+                    par.lay = *layPtr;
+                    state = 2;
+
+                    /* Loop through states 1-4 until state is zero (AKA particle has escaped) */
+                    while ( state ) {
+                        switch( state ) {
+                        case 1:
+                            state = scatter( par );
+                            break;
+
+                        case 2:
+                            state = propagate( par );
+                            break;
+
+                        case 3:
+                            state = boundary( par, layAir, layerVec );
+                            break;
+
+                        case 4:
+                            state = tally.escape( par, n, b );
+                            break;
+                    }
+                    }
+                    COUNT_EVENT( par.counters.endPhoton( 1 - T ) );
+                    tally.endPhoton( par, n );
+                }
+                tally.endBatch( par, n, b );
+
+                /* Mark the photons of the batch on the timeline of this thread */
+                if ( timer.timeline.on ) {
+                    timer.timeline.add( "photons", batchStart, timer.timeline.now(), "\"stream\": " + to_string( n ) +
+                        ", \"batch\": " + to_string( b ) + ", \"particles\": " + to_string( sliceEnd - sliceStart ) );
+                }
+                }
+                COUNT_EVENT( countProc.at(n).add( par.counters ) );
+            };
+
+            /* Tally thread c adds the records of the rings c, c + pipeTally, ... to the tallies
+            of their batches, until the transport threads of all of them are done */
+            auto drain = [&]( unsigned int c ) {
+                Weight weight( mutVec, etaaVec );
+                weight.setReference( layerVec );
+                TallyKernel kernel = tallyKernel( mutSize, etaaSize, layerVec.size() );
+                unsigned int b, ind;
+                bool open = true;
+                while ( open ) {
+                    bool idle = true;
+                    open = false;
+                    for ( unsigned int p = c; p < numFeed; p += options.pipeTally ) {
+                        bool closed = rings.at(p).closed();
+                        while ( rings.at(p).pop( weight, b, ind ) ) {
+                            kernel( weight, arsProc.at(b), ind );
+                            idle = false;
+                        }
+                        open = open || !closed;
+                    }
+                    if ( idle && open ) {
+                        this_thread::yield();
+                    }
+                }
+            };
+
+            /* A round runs in slices, between which the run can be saved (checkpoint option).
+            Each stream sends the particles of its batches in the same order either way. */
+            for ( unsigned int s = s0; s < numSlices; s++ ) {
+                sliceStart = (unsigned long long) s * perBatch / numSlices;
+                sliceEnd = (unsigned long long) ( s+1 ) * perBatch / numSlices;
+
+                /* Within a sweep, the chunks are tasks of the shared thread pool, so that threads
+                without a job of their own take over chunks of the others */
+                timer.begin( "transport" );
+                if ( omp_in_parallel() ) {
+                    #pragma omp taskloop grainsize(1)
+                    for ( unsigned int n = 0; n < numProc; n++ ) {
+                        chunk( n );
+                    }
+                }
+                /* The threads of the shared tally flush together, so each runs the chunk of its
+                own stream, and all of them have to be there */
+                else if ( tiled ) {
+                    bool missing = false;
+                    #pragma omp parallel num_threads( numProc )
+                    {
+                        if ( omp_get_num_threads() == (int) numProc ) {
+                            chunk( omp_get_thread_num() );
+                        }
+                        else {
+                            missing = true;
+                        }
+                    }
+                    if ( missing ) {
+                        result.error = "gridTiles did not get " + to_string( numProc ) + " threads";
+                        cerr << "Error: " << result.error << " (in inverse.cpp)." << endl;
+                        return false;
+                    }
+                }
+
+                /* Transport thread t sends the streams t, t + numFeed, ... and pushes to ring t.
+                The streams of a ring have batches of their own, so no two tally threads add to
+                the same batch. */
+                else if ( pipelined ) {
+                    bool missing = false;
+                    for ( unsigned int p = 0; p < numFeed; p++ ) {
+                        rings.at(p).open();
+                    }
+                    #pragma omp parallel num_threads( numProc )
+                    {
+                        unsigned int t = omp_get_thread_num();
+                        if ( omp_get_num_threads() != (int) numProc ) {
+                            missing = true;
+                        }
+                        else if ( t < numFeed ) {
+                            for ( unsigned int n = t; n < numProc; n += numFeed ) {
+                                chunk( n );
+                            }
+                            rings.at(t).close();
+                        }
+                        else {
+                            drain( t - numFeed );
+                        }
+                    }
+                    if ( missing ) {
+                        result.error = "pipeline did not get " + to_string( numProc ) + " threads";
+                        cerr << "Error: " << result.error << " (in inverse.cpp)." << endl;
+                        return false;
+                    }
+                }
+                else {
+                    #pragma omp parallel for
+                    for ( unsigned int n = 0; n < numProc; n++ ) {
+                        chunk( n );
+                    }
+                }
+                timer.end();
+                numDone += numBatch * ( sliceEnd - sliceStart ) * numRanks;
+
+                /* Save the run so far once the checkpoint interval has passed */
+                if ( checkpointing && ( omp_get_wtime() - lastCheckpoint >= options.checkpointInterval ) ) {
+                    timer.begin( "checkpoint" );
+                    saved.iter = a;
+                    saved.round = r;
+                    saved.slice = s+1;
+                    saved.numParticles = numParticles;
+                    saved.numDone = numDone;
+                    saved.settled = settled;
+                    saved.elapsed = omp_get_wtime() - wall0;
+                    saved.lastBox = lastBox;
+                    saved.mutVec = mutVec;
+                    saved.etaaVec = etaaVec;
+                    saved.paramOut = paramOut;
+                    saved.arsProc = arsProc;
+                    saved.arsNProc = arsNProc;
+                    if ( !saved.write( options.checkpointPath, sprngptrarr, numProc ) ) {
+                        result.error = "the checkpoint could not be written";
+                        return false;
+                    }
+                    lastCheckpoint = omp_get_wtime();
+                    timer.end();
+                }
+            }
+            s0 = 0;
+
+            /* End the iteration if the next round would overrun the time budget. After the last
+            round, the next round is in the next iteration, which has twice the particles. */
+            double roundTime = omp_get_wtime() - roundStart;
+            if ( r == numRounds-1 ) {
+                roundTime *= 2;
+            }
+            if ( Ranks::fromRoot( ( options.timeBudget > 0 ) && ( ( a < numIter-1 ) || ( r < numRounds-1 ) ) &&
+                ( omp_get_wtime() - wall0 + roundTime > options.timeBudget ) ) ) {
+                outOfTime = true;
+                break;
+            }
+
+            /* End the iteration once the region of the running ARS stays the same, to within one
+            grid point on every side, for three rounds in a row */
+            if ( ( numRounds > 1 ) && ( r < numRounds-1 ) && !newton && !scanN && !batchMode &&
+                !setup.forwardOnly && ( a < numIter-1 ) ) {
+                timer.begin( "settle" );
+                ars = arsInitial;
+                for ( unsigned int p=0; p < numTally; p++ ) {
+                    addVec( ars, arsProc.at(p), mutSize, etaaSize );
+                }
+                Ranks::reduce( ars );
+                fixARS( ars, numDone, mutSize, etaaSize );
+                if ( !scoreParam( ars, likGrid, expData, mutSize, etaaSize ) ) {
+                    result.error = "the ARS could not be scored";
+                    return false;
+                }
+                subFromMax( likGrid, mutSize, etaaSize );
+
+                bool same = regionBox( likGrid, mutVec, etaaVec, box ) && ( box.size() == lastBox.size() );
+                for ( unsigned int k = 0; k < box.size() && same; k++ ) {
+                    same = ( abs( box.at(k) - lastBox.at(k) ) <= 1 );
+                }
+                if ( same ) {
+                    settled++;
+                }
+                else {
+                    settled = 0;
+                }
+                lastBox = box;
+                timer.end();
+
+                if ( settled == 2 ) {
+                    progress << "Region settled after " << r+1 << " of " << numRounds << " rounds" << endl;
+                    break;
+                }
+            }
+        }
+
+        if ( escapeLog.on && !escapeLog.close( numDone ) ) {
+            result.error = "the escape log could not be written";
+            return false;
+        }
+
+        /* Add up the tallies of all ranks, and then the parallel solutions to attain total ARS */
+        timer.begin( "reduce" );
+        vector<vector<vector<vector<double> > >*> tallies;
+        for ( unsigned int p=0; p < numTally; p++ ) {
+            tallies.push_back( &arsProc.at(p) );
+        }
+        for ( unsigned int p=0; p < numProc; p++ ) {
+            for ( unsigned int k = 0; k < arsN.size() && scanN; k++ ) {
+                tallies.push_back( &arsNProc.at(p).at(k) );
+            }
+            if ( newton ) {
+                tallies.push_back( &derivProc.at(p) );
+            }
+        }
+        Ranks::reduce( tallies );
+        ars = arsInitial;
+        for ( unsigned int p=0; p < numTally; p++ ) {
+            addVec( ars, arsProc.at(p), mutSize, etaaSize );
+        }
+#ifdef COUNT_EVENTS
+        events.push_back( EventCounters() );
+        for ( unsigned int p=0; p < numProc; p++ ) {
+            events.back().add( countProc.at(p) );
+        }
+        events.back().reduce();
+#endif
+        for ( unsigned int p=0; p < numProc; p++ ) {
+            for ( unsigned int k = 0; k < arsN.size() && scanN; k++ ) {
+                addVec( arsN.at(k), arsNProc.at(p).at(k), mutSize, etaaSize );
+            }
+            if ( newton ) {
+                addVec( deriv, derivProc.at(p), 6, 1 );
+            }
+        }
+
+/******************  End of forward Monte Carlo simulation  *******************/
+
+        /* Match ars format to experimental data, which shifts by half of an angle division. */
+        timer.begin( "fixARS" );
+        fixARS( ars, numDone, mutSize, etaaSize );
+        for ( unsigned int k = 0; k < arsN.size() && scanN; k++ ) {
+            fixARS( arsN.at(k), numDone, mutSize, etaaSize );
+        }
+        timer.end();
+
+        /* Report how far the single precision tallies are from double precision ones */
+        if ( options.floatCheck && ( floatProc.size() > 0 ) ) {
+            vector<vector<vector<double> > > arsCheck = arsInitial;
+            for ( unsigned int p=0; p < numProc; p++ ) {
+                floatProc.at(p).flushExact( arsCheck );
+            }
+            Ranks::reduce( arsCheck );
+            fixARS( arsCheck, numDone, mutSize, etaaSize );
+            double arsErr = 0, likErr = 0;
+            for ( unsigned int i = 0; i < mutSize; i++ ) {
+                for ( unsigned int j = 0; j < etaaSize; j++ ) {
+                    for ( unsigned int k = 0; k < arsCheck.at(i).at(j).size(); k++ ) {
+                        double exact = arsCheck.at(i).at(j).at(k);
+                        if ( exact != 0 ) {
+                            arsErr = max( arsErr, fabs( ars.at(i).at(j).at(k) - exact ) / fabs( exact ) );
+                        }
+                    }
+                }
+            }
+            vector<vector<double> > likCheck = likGrid;
+            if ( !scoreParam( ars, likGrid, expData, mutSize, etaaSize ) ||
+                !scoreParam( arsCheck, likCheck, expData, mutSize, etaaSize ) ) {
+                result.error = "the ARS could not be scored";
+                return false;
+            }
+            for ( unsigned int i = 0; i < mutSize; i++ ) {
+                for ( unsigned int j = 0; j < etaaSize; j++ ) {
+                    likErr = max( likErr, fabs( likGrid.at(i).at(j) - likCheck.at(i).at(j) ) );
+                }
+            }
+            ostringstream line;
+            line << setprecision( 3 ) << "Float tallies in iteration " << a+1 << ": largest relative ARS error "
+                << arsErr << ", largest log-likelihood difference " << likErr;
+            report.push_back( line.str() );
+            progress << report.back() << endl;
+        }
+
+        /* Hand the first forward run to the caller instead of fitting */
+        if ( setup.forwardOnly ) {
+            result.ars.swap( ars );
+            return true;
+        }
+
+        /* Running out of time makes this the last iteration */
+        bool last = ( a == numIter-1 ) || outOfTime;
+        if ( outOfTime ) {
+            stopReason = "time budget reached";
+        }
+
+        /* Score every curve of a batch and cover all of their search regions, from a few
+        basis curves of the ARS with the reducedBasis option */
+        timer.begin( "score" );
+        if ( batchMode ) {
+            if ( options.reducedRank > 0 ) {
+                reduced.build( ars, mutSize, etaaSize, options.reducedRank, progress );
+            }
+            if ( !curveBatch.update( ars, reduced, mutVec.at(0), etaaVec.at(0), last, progress ) ) {
+                result.error = "the batch could not be updated";
+                return false;
+            }
+            timer.end();
+            if ( last ) {
+                break;
+            }
+            numParticles *= 2;
+            continue;
+        }
+
+        /* Take a trust region step instead of resizing the search region */
+        timer.end();
+        if ( newton ) {
+            fixARS( deriv, numDone, 6, 1 );
+            if ( !trust.update( deriv, ars.at(0).at(0), expData, last, paramOut.at(0), progress ) ) {
+                result.error = "the trust region step failed";
+                return false;
+            }
+            etaaVec.at(0).at(0) = trust.etaaInc;
+            mutVec.at(0).at(0) = trust.mutInc;
+            if ( last ) {
+                break;
+            }
+            numParticles *= 2;
+            continue;
+        }
+
+        /* Evaluate log-likelihood for each mut and etaa combination */
+        timer.begin( "score" );
+        if ( !scoreParam( ars, likGrid, expData, mutSize, etaaSize ) ) {
+            result.error = "the ARS could not be scored";
+            return false;
+        }
+        timer.begin( "subFromMax" );
+        subFromMax( likGrid, mutSize, etaaSize );
+        timer.end();
+
+        /* Stop early once the contours are stable, otherwise pick the next particle count */
+        unsigned int nextParticles = 2 * numParticles;
+        if ( adaptive && !last ) {
+            double noise = budget.mleNoise( arsProc, likGrid, expData, numDone/numBatch,
+                mutVec, etaaVec );
+            progress << "Relative MLE error: " << setprecision( 3 ) << noise << endl;
+            if ( budget.converged( likGrid, mutVec, etaaVec, noise, paramOut ) ) {
+                stopReason = "MLE and contour stable within tolerance";
+                for ( unsigned int l = 0; l < layerVec.size(); l++ ) {
+                    if ( layerVec.size() > 1 ) {
+                        progress << "Layer " << l+1 << ":" << endl;
+                    }
+                    progress << "eta_a = " << paramOut.at(l).at(3) << endl;
+                    progress << "mu_t = " << paramOut.at(l).at(4) << endl << endl;
+                }
+                break;
+            }
+            nextParticles = budget.nextParticles( numParticles, noise, numBatch );
+        }
+
+        /* Resize the search region of each layer. Quit program if updateInterval has an error. */
+        timer.begin( "updateInterval" );
+        for ( unsigned int l = 0; l < layerVec.size(); l++ ) {
+            if ( layerVec.size() > 1 ) {
+                progress << "Layer " << l+1 << ":" << endl;
+            }
+            profileLayer( likGrid, layerGrid, l, mutVec, etaaVec );
+            if ( !updateInterval( layerGrid, paramOut.at(l), mutVec.at(l), etaaVec.at(l), last, progress ) ) {
+                if ( !outOfTime ) {
+                    result.error = "the search region could not be updated";
+                    return false;
+                }
+
+                /* Out of time without a contour: report the discrete maximum */
+                int i0 = 0, j0 = 0;
+                discMax( layerGrid, i0, j0, mutVec.at(l).size(), etaaVec.at(l).size(), false );
+                paramOut.at(l).assign( 5, 0 );
+                paramOut.at(l).at(3) = etaaVec.at(l).at(j0);
+                paramOut.at(l).at(4) = mutVec.at(l).at(i0);
+                stopReason = "time budget reached, discrete maximum only";
+            }
+        }
+
+        timer.end();
+
+        /* Scan the profile log-likelihood over the n grid */
+        if ( scanN && !profileIndex( arsN, expData, options.nGrid, nProfile, nFit, mutSize, etaaSize,
+            progress ) ) {
+            result.error = "the index profile could not be scanned";
+            return false;
+        }
+        if ( last ) {
+            break;
+        }
+        numParticles = nextParticles;
+    }
+
+/***********************  End of inverse algorithm ****************************/
+
+    /* Report the time of each phase of every iteration */
+    timer.finish( numDone );
+    for ( unsigned int it = 0; it < timer.particles.size(); it++ ) {
+        report.push_back( timer.summary( it ) );
+        progress << report.back() << endl;
+    }
+
+    /* Report the transport events and the weight balance of every iteration (COUNT_EVENTS build) */
+    for ( unsigned int it = 0; it < events.size(); it++ ) {
+        vector<string> lines = events.at(it).summary( it );
+        for ( unsigned int k = 0; k < lines.size(); k++ ) {
+            report.push_back( lines.at(k) );
+            progress << report.back() << endl;
+        }
+        if ( fabs( events.at(it).balanceError() ) > 1e-9 ) {
+            cerr << "Error: weight is not conserved in iteration " << it+1 << " (in inverse.cpp)." << endl;
+        }
+    }
+
+    layPtr = NULL;
+
+    /* Report why an adaptive or time budgeted run stopped */
+    if ( adaptive || ( options.timeBudget > 0 ) ) {
+        progress << "Stopped: " << stopReason << " (" << a+1 << " iterations, "
+            << numDone << " particles in the last)" << endl;
+        report.push_back( "Stopped: " + stopReason );
+        report.push_back( "Iterations: " + to_string( a+1 ) );
+        report.push_back( "Particles in last iteration: " + to_string( numDone ) );
+    }
+    /* A finished run has nothing to resume */
+    if ( checkpointing ) {
+        remove( options.checkpointPath.c_str() );
+    }
+    result.fit = true;
+    return true;
+}
@@ -0,0 +1,78 @@
+#include "adaptiveBudget.h"
+#include "addVec.h"
+#include "arsLibrary.h"
+#include "boundary.h"
+#include "checkpoint.h"
+#include "curveBatch.h"
+#include "detect.h"
+#include "detectDeriv.h"
+#include "detectN.h"
+#include "escapeLog.h"
+#include "escapeRing.h"
+#include "escapeTally.h"
+#include "eventCounters.h"
+#include "floatTally.h"
+#include "fixARS.h"
+#include "layer.h"
+#include "particle.h"
+#include "phaseTimer.h"
+#include "profileIndex.h"
+#include "profileLayer.h"
+#include "propagate.h"
+#include "reducedArs.h"
+#include "ranks.h"
+#include "regionBox.h"
+#include "runOptions.h"
+#include "scatter.h"
+#include "scoreParam.h"
+#include "specularR.h"
+#include "subFromMax.h"
+#include "tiledTally.h"
+#include "trustRegion.h"
+#include "updateInterval.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <math.h>
+#include "omp.h"
+
+#ifdef SPRNGFIVE
+#include "sprng_cpp.h"
+#endif
+
+using namespace std;
+
+#pragma once
+
+struct InverseSetup {
+    InverseSetup();
+    vector<Layer> layerVec;
+    vector<vector<double> > mutVec, etaaVec;
+    vector<double> expData;
+    unsigned int numParticles, numIter, numProc;
+    double radius;
+    RunOptions options;
+    CurveBatch curveBatch;
+    bool forwardOnly;
+    ostream* progress;
+};
+
+struct InverseResult {
+    vector<vector<double> > paramOut;
+    vector<double> nProfile, nFit;
+    vector<string> report;
+    vector<vector<vector<double> > > ars;
+    PhaseTimer timing;
+    vector<EventCounters> events;
+    bool fit;
+    string error;
+};
+
+#ifdef SPRNGFIVE
+bool inverse( InverseSetup&, Sprng**, InverseResult& );
+#else
+bool inverse( InverseSetup&, int**, InverseResult& );
+#endif
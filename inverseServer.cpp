@@ -0,0 +1,173 @@
+#include "inverseServer.h"
+
+/* InverseServer keeps the program running as a service that fits one ARS curve per
+request, so that the random number streams of solver, the thread pool and the settings of
+the input file are set up once instead of for every fit. Requests are read from stdin if
+path is "-", or else from the connections to a Unix domain socket at path, one connection
+after the other. A request is one line of keywords followed by their values (see
+readRequest.cpp), and every value that is not given is taken from the input file. A seed
+is ignored, since the streams of solver go on from one request to the next. The line
+"ping" is answered with "pong", and "quit" stops the server. Every other request is
+answered with one line,
+    ok id name mu_s value mu_a value eta_a value mu_t value coeffs a b c ms time
+with "n value" added if the index of refraction is scanned, or with "error id name"
+followed by what failed (result.error, or that the request could not be read). The
+progress of the inverse algorithm is forwarded to stderr once the request is answered, so
+that stdout (or the socket) only holds the answers, and its errors go to stderr as they are
+printed. InverseServer returns
+FALSE if the socket could not be set up. */
+
+/* Variables:
+    defaults: The setup from the input file, which every request starts from
+    solver: The random number streams that every request continues
+    path: "-" for stdin and stdout, or else the path of the socket
+    inFd, outFd: The file descriptors requests are read from and answers written to
+    pending: Input that was read but not yet split into lines
+    log: The progress the inverse algorithm printed while the request ran
+    quit: Whether a request asked the server to stop
+*/
+
+/******************************************************************************/
+
+/* Runs the inverse algorithm for one request and returns the line to answer it with.
+The progress printed meanwhile is forwarded to stderr. */
+static string answer( const string& line, const InverseSetup& defaults, Solver& solver ) {
+    InverseSetup setup = defaults;
+    InverseResult result;
+    string id = "-";
+    ostringstream log, reply;
+    double wall0 = omp_get_wtime();
+
+    setup.progress = &log;
+    int seed = 0;
+    if ( !readRequest( line, setup, id, seed ) ) {
+        reply << "error id " << id << " the request could not be read";
+        return reply.str();
+    }
+    bool fit = solver.inverse( setup, result );
+    cerr << log.str() << flush;
+    if ( !fit ) {
+        reply << "error id " << id << " " << result.error;
+        return reply.str();
+    }
+
+    const vector<double>& param = result.paramOut.at(0);
+    reply << setprecision( 6 ) << "ok id " << id
+        << " mu_s " << param.at(4) * ( 1 - param.at(3) )
+        << " mu_a " << param.at(4) * param.at(3)
+        << " eta_a " << param.at(3) << " mu_t " << param.at(4)
+        << " coeffs " << param.at(0) << " " << param.at(1) << " " << param.at(2);
+    if ( result.nFit.size() > 0 ) {
+        reply << " n " << result.nFit.at(0);
+    }
+    reply << " ms " << setprecision( 4 ) << 1000 * ( omp_get_wtime() - wall0 );
+    return reply.str();
+}
+
+#ifndef _WIN32
+
+/* Writes one line to a file descriptor, whatever size the writes come in */
+static bool writeLine( int outFd, string line ) {
+    line += '\n';
+    size_t done = 0;
+    while ( done < line.size() ) {
+        ssize_t written = write( outFd, line.data() + done, line.size() - done );
+        if ( written <= 0 ) {
+            return false;
+        }
+        done += written;
+    }
+    return true;
+}
+
+/* Answers the requests of one connection until it closes. Returns TRUE if a request
+asked the server to stop. */
+static bool serve( int inFd, int outFd, const InverseSetup& defaults, Solver& solver ) {
+    string pending;
+    char buffer[4096];
+
+    while ( true ) {
+        size_t end = pending.find( '\n' );
+        if ( end == string::npos ) {
+            ssize_t count = read( inFd, buffer, sizeof( buffer ) );
+            if ( count <= 0 ) {
+                return false;
+            }
+            pending.append( buffer, count );
+            continue;
+        }
+
+        string line = pending.substr( 0, end );
+        pending.erase( 0, end+1 );
+        if ( ( line.size() > 0 ) && ( line[line.size()-1] == '\r' ) ) {
+            line.resize( line.size()-1 );
+        }
+        if ( line.find_first_not_of( " \t" ) == string::npos ) {
+            continue;
+        }
+        if ( line == "quit" ) {
+            return true;
+        }
+        if ( !writeLine( outFd, ( line == "ping" ) ? "pong" : answer( line, defaults, solver ) ) ) {
+            return false;
+        }
+    }
+}
+
+#endif
+
+bool inverseServer( const InverseSetup& defaults, Solver& solver, const string& path ) {
+#ifdef _WIN32
+    cerr << "Error: daemon needs a POSIX system (in inverseServer.cpp)." << endl;
+    return false;
+#else
+    if ( path == "-" ) {
+        cout << flush;
+        serve( 0, 1, defaults, solver );
+        return true;
+    }
+
+    struct sockaddr_un address;
+    memset( &address, 0, sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    if ( path.size() >= sizeof( address.sun_path ) ) {
+        cerr << "Error: socket path " << path << " is too long (in inverseServer.cpp)." << endl;
+        return false;
+    }
+    strncpy( address.sun_path, path.c_str(), sizeof( address.sun_path )-1 );
+
+    /* A socket left by an earlier server is replaced */
+    unlink( path.c_str() );
+    int listenFd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( ( listenFd < 0 ) || ( bind( listenFd, (struct sockaddr*) &address, sizeof( address ) ) != 0 ) ||
+        ( listen( listenFd, 8 ) != 0 ) ) {
+        cerr << "Error: could not listen on socket " << path << " (in inverseServer.cpp)." << endl;
+        if ( listenFd >= 0 ) {
+            close( listenFd );
+        }
+        return false;
+    }
+    cerr << "Listening on " << path << endl;
+
+    /* A client that hangs up early must not end the server */
+    signal( SIGPIPE, SIG_IGN );
+
+    /* Connections are served one after the other, since every fit uses all the streams */
+    bool quit = false;
+    while ( !quit ) {
+        int connFd = accept( listenFd, NULL, NULL );
+        if ( ( connFd < 0 ) && ( errno == EINTR ) ) {
+            continue;
+        }
+        if ( connFd < 0 ) {
+            cerr << "Error: could not accept a connection on " << path << " (in inverseServer.cpp)." << endl;
+            break;
+        }
+        quit = serve( connFd, connFd, defaults, solver );
+        close( connFd );
+    }
+    close( listenFd );
+    unlink( path.c_str() );
+    return true;
+#endif
+}
@@ -0,0 +1,23 @@
+#include "readRequest.h"
+#include "solver.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include "omp.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+using namespace std;
+
+#pragma once
+
+bool inverseServer( const InverseSetup&, Solver&, const string& );
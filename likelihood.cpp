@@ -26,3 +26,23 @@ double likelihood( const vector<double>& vec1, const vector<double>& vec2 ){
 
     return N/2.0 * log( sumStore / double( N ) );
 }
+
+/* Overload for the reducedBasis option: evaluates the same log-likelihood from the
+coefficients of the ARS curve and of the experimental curve in an orthonormal basis
+(see reducedArs.cpp). perpSS is the part of the sum of squares of the experimental curve
+outside of the basis, and N the number of angles. */
+double likelihood( const vector<double>& coeffs, const vector<double>& expCoeffs, double perpSS,
+    unsigned int N ) {
+    double sumStore = perpSS;
+
+    if ( coeffs.size() != expCoeffs.size() ) {
+        cerr << "Error: vectors not the same size (from likelihood.cpp)." << endl;
+        return numeric_limits<double>::quiet_NaN();
+    }
+
+    for ( unsigned int i = 0; i < coeffs.size(); i++ ) {
+        sumStore += pow( coeffs.at(i) - expCoeffs.at(i), 2 );
+    }
+
+    return N/2.0 * log( sumStore / double( N ) );
+}
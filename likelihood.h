@@ -8,3 +8,4 @@ using namespace std;
 #pragma once
 
 double likelihood( const vector<double>&, const vector<double>& );
+double likelihood( const vector<double>&, const vector<double>&, double, unsigned int );
@@ -10,48 +10,91 @@ Physical Measurement Lab
 Sensor Science Division
 Remote Sensing Group
 
-Main first initializes all variables, seeds the RNG, and reads the input files. It then
-zeros out the ars vectors (the solutions to the forward MC simulation) and sets the reference
-importance sampling mua and mus values to the median of the input mut and etaa vectors. It
-declares functions within the parallel for loop to eliminate race conditions. Next, it runs
-the forward MC simulation on all particles, cycling between four states: scatter, propagate,
-boundary, and detect, until the particle escapes or vanishes in the material. It updates the
-search interval, doubles number of particles, and repeats again. */
+Main is a thin driver of the library (see solver.cpp). It reads the input files, seeds
+the RNG with a Solver, runs the inverse algorithm (see inverse.cpp) on the experimental
+data and saves the results with dataOut, or with the curve batch for the batch option. With the daemon
+option, it instead keeps running as a service that answers fit requests with the same
+RNG streams and settings (see inverseServer.cpp), and with the sweep option, it runs the
+jobs of a job list together on one pool of threads (see sweep.cpp). With the forward option,
+it only runs the forward model at the center of the search grid (see forwardPoint.cpp) and
+saves its ARS. Built with USE_MPI
+(make mpi) and started with mpirun, the ranks share the particles of every forward run. */
 
 /* Variables:
     numParticles: Number of particles to send through medium (forward MC simulation)
     numIter: Number of times to resize the search box (inverse)
     numProc: Number of processors to use (parallelization)
     seed, seedIn: seed for random number generator. If seedIn is 0, time(NULL) is used
+    argc, argv: Command line arguments. --resume goes on from the last checkpoint
     radius: Radius of detector
     layerVec: Vector holding parameters for all layers in the material
-    mutVec, etaaVec: List of mut's and etaa's to search over (mut = mua+mus, etaa = mua/mut)
+    mutVec, etaaVec: List of mut's and etaa's of each layer to search over (mut = mua+mus,
+        etaa = mua/mut)
     expData: List of experimental angle resolved scattering results
-    angleDiv: Number of divisions of ARS to measure
-    T: Specular transmission, particles that initially make it into the medium
-    ars, arsProc: Store the angle resolved scattering results (forward MC simulation)
-    likGrid: The likelihood values for each point in the grid of mut and etaa
+    options: Optional settings from the input file
+    curveBatch: The experimental curves of a batch (batch option)
+    solver: The random number streams of the processors
+    setup, result: The inputs and the results of the inverse algorithm
+    point: The results of a forward run at one point (forward option)
+    done: Whether the inverse algorithm ended without an error
 */
 
-int main() {
+int main( int argc, char* argv[] ) {
 
 /**********************  Inputs and Initialization  ***************************/
 
+    /* In an MPI run, every rank reads the input files, but only rank 0 prints and saves
+    (except for the trace option) */
+    Ranks::start();
+    atexit( Ranks::stop );
+    if ( Ranks::rank() > 0 ) {
+        cout.rdbuf( NULL );
+    }
+
     /* Read in experimental data, set parameters from file. */
     int seed, seedIn, time0 = time(NULL);
     unsigned int numParticles, numIter, numProc;
     double radius;
     vector<Layer> layerVec( 1 );
-    Layer layAir;
-    vector<double> mutVec, etaaVec, expData;
-    fileToVec( expData, "dataIn/exp.txt" );
+    vector<vector<double> > mutVec, etaaVec;
+    vector<double> expData;
+    RunOptions options;
+    CurveBatch curveBatch;
 
     /* Quit the program if there is an input error. */
     if ( !setParameters( layerVec, mutVec, etaaVec, numParticles,
-        numIter, numProc, seedIn, radius ) ) {
+        numIter, numProc, seedIn, radius, options ) ) {
+        return 1;
+    }
+
+    /* --resume goes on from the file of the checkpoint option */
+    for ( int i = 1; i < argc; i++ ) {
+        if ( string( argv[i] ) == "--resume" ) {
+            options.resume = true;
+        }
+        else {
+            cerr << "Error: unknown argument " << argv[i] << " (in main.cpp)." << endl;
+            return 1;
+        }
+    }
+    if ( options.resume && options.checkpointPath.empty() ) {
+        cerr << "Error: --resume needs the checkpoint option (in main.cpp)." << endl;
         return 1;
     }
 
+    /* A batch of curves replaces exp.txt. The first curve sets the number of angles. */
+    bool batchMode = ( options.batchPath.size() > 0 );
+    if ( batchMode ) {
+        if ( !curveBatch.read( options.batchPath ) ) {
+            return 1;
+        }
+        cout << "Batch of " << curveBatch.curves.size() << " curves" << endl;
+        expData = curveBatch.curves.at(0);
+    }
+    else {
+        fileToVec( expData, "dataIn/exp.txt" );
+    }
+
     if (seedIn == 0) {
        seed = time0;
     }
@@ -60,133 +103,72 @@ int main() {
        seed = seedIn;
     }
 
-    /* Seed the random number generator, depending on which version of
-    SPRNG is present. */
-#ifdef SPRNGFIVE
-    int gtype = 2;
-    /* Seed the RNG */
-    Sprng *stream, **sprngptrarr;
-    stream = SelectType(gtype);
-    stream->init_sprng(0, 1, seed, SPRNG_DEFAULT);
-
-    unsigned int nspawned = stream->spawn_sprng(numProc,&sprngptrarr);
-
-    if(nspawned != numProc)
-    {
-        cout <<  "Error: " << nspawned << " actual out of " << numProc << " wanted streams spawned! " << endl;
-        return 1;
+    /* Collect the inputs of the inverse algorithm */
+    InverseSetup setup;
+    setup.layerVec = layerVec;
+    setup.mutVec = mutVec;
+    setup.etaaVec = etaaVec;
+    setup.expData = expData;
+    setup.numParticles = numParticles;
+    setup.numIter = numIter;
+    setup.numProc = numProc;
+    setup.radius = radius;
+    setup.options = options;
+    setup.curveBatch = curveBatch;
+
+    /* Run every job of a job list at once, each with streams of its own */
+    if ( options.sweepPath.size() > 0 ) {
+        return sweep( setup, seed, options.sweepPath ) ? 0 : 1;
     }
 
-#else
-    int **sprngptrarr;
-    if ( !initSPRNG( numProc, &sprngptrarr, seed ) ) {
+    /* Seed the random number generator, with one stream for each processor */
+    Solver solver;
+    if ( !solver.init( numProc, seed ) ) {
         return 1;
     }
-#endif
-
-    /* Initialize variables */
-
-    /* Doubles, ints, and chars */
-    unsigned int angleDiv = 2 * ( expData.size() );
-    unsigned int mutSize = mutVec.size(), etaaSize = etaaVec.size();
-    double T = 1 - specularR( layerVec.at(0) );
 
-    /* Initialize vectors that need earlier information */
-    omp_set_num_threads( numProc );
-    vector<vector<vector<double> > > arsInitial( mutSize, vector<vector<double> >
-        ( etaaSize, vector<double>( angleDiv, 0 ) ) ), ars;
-    vector<vector<vector<vector<double> > > > arsProcInitial( numProc, vector<vector<vector<double> > >
-        ( mutSize, vector<vector<double> >( etaaSize, vector<double>( angleDiv, 0 ) ) ) ), arsProc;
-    vector<double> paramOut(5);
-    vector<vector<double> > likGrid( mutSize, vector<double>( etaaSize, 0 ) );
-
-    Layer *layPtr;
-    layPtr = &layerVec.at(0);
-
-/*********************  End of inputs and initialization  *********************/
-
-/****************************  Inverse algorithm  *****************************/
-
-    /* Control loop for inverse: resets bounding box and doubles particles each time. */
-    for ( unsigned int a = 0; a < numIter; a++ ) {
-        ars = arsInitial;
-        arsProc = arsProcInitial;
-        layerVec.at(0).setMua( mutVec.at( mutVec.size()/2 ) * etaaVec.at( etaaVec.size()/2 ) );
-        layerVec.at(0).setMus( mutVec.at( mutVec.size()/2 ) - layerVec.at(0).getMua() );
-
-/*********************  Forward Monte Carlo Simulation  ***********************/
-
-        #pragma omp parallel for
-        for ( unsigned int n = 0; n < numProc; n++ ) {
-
-            /* Safe initializations within the parallel loop to eliminate race conditions */
-            Particle par( T, mutVec, etaaVec, sprngptrarr[n] );
-            int state;
-            int propagate( Particle& );
-            int detect( Particle&, double, unsigned int, vector<vector<vector<double> > >
-                &, unsigned int, unsigned int );
-            int scatter( Particle& );
-            int boundary( Particle&, Layer&, vector<Layer>& );
-
-            /* Send particle through the material */
-            for ( unsigned int i = 0; i < numParticles/numProc; i++ ) {
-
-                /* Reset particle weight/position and put the particle in the first layer */
-                par.reset( T );
-                par.lay = *layPtr;
-                state = 2;
-
-                /* Loop through states 1-4 until state is zero (AKA particle has escaped) */
-                while ( state ) {
-                    switch( state ) {
-                    case 1:
-                        state = scatter( par );
-                        break;
-
-                    case 2:
-                        state = propagate( par );
-                        break;
-
-                    case 3:
-                        state = boundary( par, layAir, layerVec );
-                        break;
-
-                    case 4:
-                        state = detect( par, radius, angleDiv, arsProc.at(n), mutSize, etaaSize );
-                        break;
-                }
-                }
-            }
-        }
+    /* Answer fit requests until told to quit */
+    if ( options.daemonPath.size() > 0 ) {
+        return inverseServer( setup, solver, options.daemonPath ) ? 0 : 1;
+    }
 
-        /* Add together parallel solutions to attain total ARS */
-        for ( unsigned int p=0; p < numProc; p++ ) {
-            addVec( ars, arsProc.at(p), mutSize, etaaSize );
+    /* Simulate at one point, without fitting */
+    if ( options.forwardPath.size() > 0 ) {
+        PointResult point;
+        if ( !solver.point( setup, point ) ) {
+            return 1;
         }
+        cout << "Forward run: " << point.photons << " photons in " << setprecision( 3 ) << point.seconds << " s, R = "
+            << point.reflected << ", T = " << point.transmitted << endl;
+        return ( ( Ranks::rank() > 0 ) || point.write( options.forwardPath ) ) ? 0 : 1;
+    }
 
-/******************  End of forward Monte Carlo simulation  *******************/
-
-        /* Match ars format to experimental data, which shifts by half of an angle division. */
-        fixARS( ars, numParticles, mutSize, etaaSize );
+/****************************  Inverse algorithm  *****************************/
 
-        /* Evaluate log-likelihood for each mut and etaa combination */
-        if ( !scoreParam( ars, likGrid, expData, mutSize, etaaSize ) ) {
-           return 1;
-        }
-        subFromMax( likGrid, mutSize, etaaSize );
+    InverseResult result;
+    bool done = solver.inverse( setup, result );
 
-        /* Resize the search region. Quit program if updateInterval has an error. */
-        if ( !updateInterval( likGrid, paramOut, mutVec, etaaVec, a==(numIter-1) ) ) {
-            return 1;
-        }
-        numParticles *= 2;
+    /* Every rank writes the timeline of its threads (trace option) */
+    if ( options.tracePath.size() > 0 ) {
+        result.timing.timeline.write( options.tracePath + ( Ranks::rank() > 0 ? "." + to_string( Ranks::rank() ) : "" ),
+            Ranks::rank() );
+    }
+    if ( !done ) {
+        return 1;
     }
 
-/***********************  End of inverse algorithm ****************************/
-
-    sprngptrarr = NULL;
-    layPtr = NULL;
+    if ( !result.fit || ( Ranks::rank() > 0 ) ) {
+        return 0;
+    }
 
-    dataOut( paramOut, time(NULL)-time0 );
+    result.timing.write( "dataOut/MCSLtiming.csv" );
+    if ( result.events.size() > 0 ) {
+        EventCounters::write( "dataOut/MCSLevents.csv", result.events );
+    }
+    if ( batchMode ) {
+        setup.curveBatch.write( time(NULL)-time0, result.report );
+        return 0;
+    }
+    dataOut( result.paramOut, time(NULL)-time0, options.nGrid, result.nProfile, result.nFit, result.report );
     return 0;
 }
@@ -1,21 +1,38 @@
+#include "adaptiveBudget.h"
 #include "addVec.h"
+#include "arsLibrary.h"
 #include "boundary.h"
+#include "curveBatch.h"
 #include "detect.h"
+#include "detectDeriv.h"
+#include "detectN.h"
 #include "fileToVec.h"
 #include "fixARS.h"
 #include "initSPRNG.h"
+#include "inverse.h"
+#include "inverseServer.h"
 #include "layer.h"
 #include "particle.h"
+#include "profileIndex.h"
+#include "profileLayer.h"
 #include "propagate.h"
+#include "ranks.h"
+#include "reducedArs.h"
+#include "regionBox.h"
 #include "dataOut.h"
+#include "runOptions.h"
 #include "scatter.h"
 #include "scoreParam.h"
 #include "setParameters.h"
+#include "solver.h"
+#include "sweep.h"
 #include "specularR.h"
 #include "subFromMax.h"
+#include "trustRegion.h"
 #include "updateInterval.h"
 #include <iostream>
 #include <ctime>
+#include <iomanip>
 #include <cstdlib>
 #include <vector>
 #include <string>
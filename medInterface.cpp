@@ -2,7 +2,7 @@
 
 /* Written by Richelle Streater, May 2017. */
 
-/* MedInterface is called by the boundary. MedInterface calculates
+/* MedInterface is called by the boundary. MedInterface calls fresnelR to find
 the Fresnel Coefficients for the boundary. It generates a uniformly distributed
 random number between zero and one, and compares the number to the Fresnel
 coefficients to determine whether to reflect or transmit. The output of medInterface
@@ -14,8 +14,6 @@ assumes a non-magnetic medium. */
     kz1, kz2: z-component of direction vector originally and if transmitted
     n1, n2: indices of refraction of current layer and layB
     x: random number between zero and one (uniform)
-    Rp: reflectance for P-polarized light
-    Rs: reflectance for S-polarized light
     R: reflectance for unpolarized light */
 
 /********************************************************************/
@@ -28,38 +26,13 @@ bool medInterface( Particle &par, Layer &layPotential, int* sprngptr ) {
 #endif
 
     /* Set up variables to reduce # of calculations */
-	double kz1, n1, n2, storeCalc, kz2, x, Rp, Rs, R;
+	double kz1, n1, n2, kz2, x, R;
 	kz1 = par.dir.at(2);
 	n1 = par.lay.getN();
 	n2 = layPotential.getN();
 
-/*******************  Find Fresnel Coefficients *********************/
-
-	/* Non-TIR case: set up Fresnel Coefficients. Use Snell's law to find kz2. */
-	storeCalc = n1*n1 * ( 1-kz1*kz1 ) / ( n2*n2 );
-	if ( storeCalc <= 1 ) {
-
-        /* If-else statement makes sure that kz1 & kz2 have the same sign */
-        if ( kz1 > 0 ) {
-            kz2 = sqrt( 1-storeCalc );
-        }
-        else {
-            kz2 = -sqrt( 1-storeCalc );
-        }
-
-        /* Fresnel's equations */
-        Rs = pow( ( ( n1*kz1 - n2*kz2 ) / ( n1*kz1 + n2*kz2 ) ), 2 );
-        Rp = pow( ( ( n2*kz1 - n1*kz2 ) / ( n2*kz1 + n1*kz2 ) ), 2 );
-        R = ( 1.0/2.0 ) * ( Rp + Rs );
-	}
-
-	/* TIR case- particle must reflect */
-	else {
-        kz2 = -kz1;
-        R = 1;
-	}
-
-/*************  End of finding Fresnel Coefficients  ****************/
+	/* Find Fresnel Coefficients, and kz2 from Snell's law (reflectance is 1 for TIR) */
+	R = fresnelR( n1, n2, kz1, kz2 );
 
 /****************  Determine whether to transmit  *******************/
 
@@ -74,6 +47,7 @@ bool medInterface( Particle &par, Layer &layPotential, int* sprngptr ) {
 	if ( x <= R ) {
         /* particle is reflected */
 		par.dir.at(2) = -kz1;
+		COUNT_EVENT( ( ( R >= 1 ) ? par.counters.totalInternal : par.counters.fresnelReflections )++ );
 	}
 
 	else {
@@ -1,3 +1,4 @@
+#include "fresnelR.h"
 #include "layer.h"
 #include "particle.h"
 #include "sprng.h"
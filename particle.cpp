@@ -8,15 +8,16 @@
     weight: an object carrying all weighting data for the particle (importance sampling)
     sprngptr: a pointer that eliminates race conditions in the parallel for loop
     layer: the layer that the particle is currently in
+    counters: the events of the particles sent with this particle (COUNT_EVENTS build)
 */
 
 /******************************************************************************/
 
 #ifdef SPRNGFIVE
-Particle::Particle ( double T, vector<double>& mutV, vector<double>& etaaV, Sprng * sprngptrin ) {
+Particle::Particle ( double T, vector<vector<double> >& mutV, vector<vector<double> >& etaaV, Sprng * sprngptrin ) {
 
 #else
-Particle::Particle ( double T, vector<double>& mutV, vector<double>& etaaV, int* sprngptrin ) {
+Particle::Particle ( double T, vector<vector<double> >& mutV, vector<vector<double> >& etaaV, int* sprngptrin ) {
 #endif
 
     /* Make a 3X1 position vector, filled with zeros */
@@ -60,11 +61,10 @@ void Particle::reset( double T ) {
     weight.reset( T );
 }
 
-/* Update weight function- updates scalar w with MCML equation and updates
-adjusted weight vector and weight vector for importance sampling. */
+/* Update weight function- updates scalar w with MCML equation. The importance
+sampling weights of the collision were counted by propagate. */
 void Particle::updateWeightScatter() {
     weight.wScale *= lay.getMusDivMut();
-    weight.updateWeightEtaa( lay.getDivVar() );
 }
 
 /* Update position function- Uses an input distance and particle direction. */
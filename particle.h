@@ -1,3 +1,4 @@
+#include "eventCounters.h"
 #include "layer.h"
 #include "weight.h"
 #include <vector>
@@ -13,11 +14,11 @@ using namespace std;
 class Particle {
     public:
     #ifdef SPRNGFIVE
-	Particle( double, vector<double>&, vector<double>&, Sprng* );
+	Particle( double, vector<vector<double> >&, vector<vector<double> >&, Sprng* );
         Sprng* sprngptr;
 
     #else
-    Particle( double, vector<double>&, vector<double>&, int* );
+    Particle( double, vector<vector<double> >&, vector<vector<double> >&, int* );
     int* sprngptr;
     #endif
 
@@ -29,4 +30,7 @@ class Particle {
 	vector<double> dir;
     Layer lay;
     Weight weight;
+    #ifdef COUNT_EVENTS
+    EventCounters counters;
+    #endif
 };
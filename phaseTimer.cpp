@@ -0,0 +1,161 @@
+#include "phaseTimer.h"
+
+/* PhaseTimer measures the wall-clock time (steady clock) and the CPU time of the whole
+process (clock, all of its threads) spent in each phase of each iteration of the inverse algorithm: the
+parallel transport loop, the reduction of the parallel tallies, fixARS, scoring, subFromMax
+and updateInterval, and the settle checks and checkpoints of the sequential and checkpoint
+options. The rest of an iteration is counted as other. A CPU time near the number of
+threads times the wall time shows a parallel phase, and one near the wall time a serial
+phase. A timer made inside a parallel region (the jobs of a sweep) leaves the CPU time out,
+since it would count the threads of every job that runs at the same time. With the trace option, each phase and iteration is also recorded as a span of the
+timeline. */
+
+/* Members:
+    phases: Names of the phases, in the columns of the timing file
+    particles: Particles sent in each iteration
+    wall, cpu: Seconds of each phase in each iteration. The last phase is the whole
+        iteration
+    withCpu: Whether the CPU time is reported, which it is not inside a parallel region
+    current, open: The phase being timed (-1 for none), and whether an iteration is
+    phaseWall, phaseCpu, iterWall, iterCpu: Start of the current phase and iteration
+    timeline: Spans of the phases, and of the photons of each thread (trace option)
+    phaseStart, iterStart: Start of the current phase and iteration on the timeline
+*/
+
+/******************************************************************************/
+
+static const char* phaseNames[] = { "transport", "reduce", "fixARS", "score", "subFromMax",
+    "updateInterval", "settle", "checkpoint", "other", "total" };
+
+PhaseTimer::PhaseTimer() {
+    phases.assign( phaseNames, phaseNames + sizeof( phaseNames ) / sizeof( phaseNames[0] ) );
+    particles.clear();
+    wall.clear();
+    cpu.clear();
+    withCpu = !omp_in_parallel();
+    current = -1;
+    open = false;
+    phaseCpu = 0;
+    iterCpu = 0;
+    phaseStart = 0;
+    iterStart = 0;
+}
+
+/* Starts timing phase, and stops the phase before it */
+void PhaseTimer::begin( const string& phase ) {
+    end();
+    for ( unsigned int k = 0; k < phases.size(); k++ ) {
+        if ( phases.at(k) == phase ) {
+            current = k;
+        }
+    }
+    phaseWall = chrono::steady_clock::now();
+    phaseCpu = clock();
+    if ( timeline.on ) {
+        phaseStart = timeline.now();
+    }
+}
+
+/* Adds the time since begin to the current phase */
+void PhaseTimer::end() {
+    if ( ( current < 0 ) || !open ) {
+        current = -1;
+        return;
+    }
+    wall.back().at( current ) += chrono::duration<double>( chrono::steady_clock::now() - phaseWall ).count();
+    cpu.back().at( current ) += double( clock() - phaseCpu ) / CLOCKS_PER_SEC;
+    if ( timeline.on ) {
+        timeline.add( phases.at( current ), phaseStart, timeline.now(), "" );
+    }
+    current = -1;
+}
+
+/* Closes the iteration that is open, which sent numDone particles, and opens the next.
+Called at the start of every iteration. */
+void PhaseTimer::nextIteration( unsigned int numDone ) {
+    finish( numDone );
+    wall.push_back( vector<double>( phases.size(), 0 ) );
+    cpu.push_back( vector<double>( phases.size(), 0 ) );
+    iterWall = chrono::steady_clock::now();
+    iterCpu = clock();
+    if ( timeline.on ) {
+        iterStart = timeline.now();
+    }
+    open = true;
+}
+
+/* Closes the iteration that is open, which sent numDone particles. Called after the last
+iteration. */
+void PhaseTimer::finish( unsigned int numDone ) {
+    end();
+    if ( open ) {
+        unsigned int other = phases.size()-2, total = phases.size()-1;
+        wall.back().at( total ) = chrono::duration<double>( chrono::steady_clock::now() - iterWall ).count();
+        cpu.back().at( total ) = double( clock() - iterCpu ) / CLOCKS_PER_SEC;
+        wall.back().at( other ) = wall.back().at( total );
+        cpu.back().at( other ) = cpu.back().at( total );
+        for ( unsigned int k = 0; k < other; k++ ) {
+            wall.back().at( other ) -= wall.back().at(k);
+            cpu.back().at( other ) -= cpu.back().at(k);
+        }
+        particles.push_back( numDone );
+        if ( timeline.on ) {
+            timeline.add( "iteration " + to_string( particles.size() ), iterStart, timeline.now(),
+                "\"particles\": " + to_string( numDone ) );
+        }
+    }
+    open = false;
+}
+
+/* Returns one line on iteration it: its particles, photons per second of the transport
+loop and of the whole iteration, and the wall (CPU) seconds of each phase that took any */
+string PhaseTimer::summary( unsigned int it ) const {
+    ostringstream line;
+    const vector<double>& w = wall.at(it);
+    const vector<double>& c = cpu.at(it);
+    double transport = ( w.at(0) > 0 ) ? particles.at(it) / w.at(0) : 0;
+    line << setprecision( 3 ) << "Iteration " << it+1 << ": " << particles.at(it) << " particles in "
+        << w.back() << " s, " << transport << " photons/s in transport, "
+        << particles.at(it) / w.back() << " overall; " << ( withCpu ? "wall (cpu) s:" : "wall s:" );
+    for ( unsigned int k = 0; k < phases.size()-1; k++ ) {
+        if ( w.at(k) >= 5e-4 ) {
+            line << " " << phases.at(k) << " " << w.at(k);
+            if ( withCpu ) {
+                line << " (" << c.at(k) << ")";
+            }
+        }
+    }
+    return line.str();
+}
+
+/* Writes one row per iteration to path, with the particles, photons per second and the
+wall and CPU seconds of every phase (only the wall seconds without withCpu). Returns FALSE if the file did not open. */
+bool PhaseTimer::write( const string& path ) const {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from phaseTimer.cpp)." << endl;
+        return false;
+    }
+
+    saveData << "iteration, particles, transport photons per second, photons per second";
+    for ( unsigned int k = 0; k < phases.size(); k++ ) {
+        saveData << ", " << phases.at(k) << " wall s";
+        if ( withCpu ) {
+            saveData << ", " << phases.at(k) << " process cpu s";
+        }
+    }
+    saveData << endl;
+    for ( unsigned int it = 0; it < particles.size(); it++ ) {
+        const vector<double>& w = wall.at(it);
+        saveData << it+1 << ", " << particles.at(it) << ", "
+            << ( ( w.at(0) > 0 ) ? particles.at(it) / w.at(0) : 0 ) << ", " << particles.at(it) / w.back();
+        for ( unsigned int k = 0; k < phases.size(); k++ ) {
+            saveData << ", " << w.at(k);
+            if ( withCpu ) {
+                saveData << ", " << cpu.at(it).at(k);
+            }
+        }
+        saveData << endl;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <ctime>
+#include "timeline.h"
+#include "omp.h"
+
+using namespace std;
+
+#pragma once
+
+class PhaseTimer {
+    public:
+    PhaseTimer();
+    void begin( const string& );
+    void end();
+    void nextIteration( unsigned int );
+    void finish( unsigned int );
+    string summary( unsigned int ) const;
+    bool write( const string& ) const;
+    vector<string> phases;
+    vector<unsigned int> particles;
+    vector<vector<double> > wall, cpu;
+    bool withCpu;
+    Timeline timeline;
+
+    private:
+    int current;
+    bool open;
+    chrono::steady_clock::time_point phaseWall, iterWall;
+    clock_t phaseCpu, iterCpu;
+    double phaseStart, iterStart;
+};
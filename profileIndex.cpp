@@ -0,0 +1,88 @@
+#include "profileIndex.h"
+
+/* ProfileIndex scans the log-likelihood over the indices of refraction in nVec. For
+each index, it scores the reweighted ARS over the grid of mut and etaa and keeps the
+best value, which is the profile log-likelihood of that index. The profile is shifted
+so that its maximum is zero, as in subFromMax. If there are at least three indices,
+profileIndex fits a parabola to the profile to find the maximum likelihood estimate
+of n and its standard error, which it prints to progress. As nVec may not go below the
+n of the run, a sample whose index is at or below it gives a profile that falls from the
+first index on, with no maximum to fit; this is noted to progress and nFit stays nan.
+ProfileIndex returns FALSE if scoreParam has an error. */
+
+/* Variables:
+    arsN: The ARS over the grid of mut and etaa for each index in nVec
+    nProfile: The profile log-likelihood for each index in nVec
+    nFit: The maximum likelihood estimate of n and its standard error (nan if no fit)
+    coeffs: Coefficients of the parabola a + b dn + c dn^2/2, with dn = n - nVec(kMax)
+*/
+
+/******************************************************************************/
+
+bool profileIndex( const vector<vector<vector<vector<double> > > >& arsN,
+    const vector<double>& expData, const vector<double>& nVec, vector<double>& nProfile,
+    vector<double>& nFit, unsigned int m, unsigned int n, ostream& progress ) {
+
+    vector<vector<double> > likGrid( m, vector<double>( n, 0 ) );
+    unsigned int kMax = 0;
+    double minVal;
+
+    nProfile.assign( nVec.size(), 0 );
+    nFit.assign( 2, numeric_limits<double>::quiet_NaN() );
+
+    /* Profile over mut and etaa: likelihood is a negative log-likelihood, so keep the minimum */
+    for ( unsigned int k = 0; k < nVec.size(); k++ ) {
+        if ( !scoreParam( arsN.at(k), likGrid, expData, m, n ) ) {
+            return false;
+        }
+        minVal = likGrid.at(0).at(0);
+        for ( unsigned int i = 0; i < m; i++ ) {
+            for ( unsigned int j = 0; j < n; j++ ) {
+                if ( likGrid.at(i).at(j) < minVal ) {
+                    minVal = likGrid.at(i).at(j);
+                }
+            }
+        }
+        nProfile.at(k) = -minVal;
+        if ( nProfile.at(k) > nProfile.at(kMax) ) {
+            kMax = k;
+        }
+    }
+
+    double maxVal = nProfile.at(kMax);
+    for ( unsigned int k = 0; k < nVec.size(); k++ ) {
+        nProfile.at(k) -= maxVal;
+    }
+
+    if ( nVec.size() < 3 ) {
+        return true;
+    }
+
+    /* Fit a parabola about the discrete maximum by least squares */
+    vector<vector<double> > A( nVec.size(), vector<double>( 3, 0 ) );
+    vector<double> coeffs( 3 );
+    double dn;
+    for ( unsigned int k = 0; k < nVec.size(); k++ ) {
+        dn = nVec.at(k) - nVec.at(kMax);
+        A.at(k) = {1, dn, dn*dn/2.0};
+    }
+    leastSquares( A, nProfile, coeffs );
+
+    if ( coeffs.at(2) >= 0 ) {
+        if ( kMax == 0 ) {
+            progress << "Note: the index profile has no interior maximum, n is at or below the smallest nGrid value"
+                << endl << endl;
+        } else if ( kMax == nVec.size() - 1 ) {
+            progress << "Note: the index profile has no interior maximum, n is at or above the largest nGrid value"
+                << endl << endl;
+        } else {
+            progress << "Note: the index profile has no interior maximum" << endl << endl;
+        }
+        return true;
+    }
+
+    nFit.at(0) = nVec.at(kMax) - coeffs.at(1) / coeffs.at(2);
+    nFit.at(1) = 1 / sqrt( -coeffs.at(2) );
+    progress << "n = " << nFit.at(0) << " +/- " << nFit.at(1) << endl << endl;
+    return true;
+}
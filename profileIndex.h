@@ -0,0 +1,13 @@
+#include "leastSquares.h"
+#include "scoreParam.h"
+#include <vector>
+#include <iostream>
+#include <limits>
+#include <math.h>
+
+using namespace std;
+
+#pragma once
+
+bool profileIndex( const vector<vector<vector<vector<double> > > >&, const vector<double>&,
+    const vector<double>&, vector<double>&, vector<double>&, unsigned int, unsigned int, ostream& );
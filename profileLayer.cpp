@@ -0,0 +1,42 @@
+#include "profileLayer.h"
+
+/* ProfileLayer finds the profile likelihood grid of one layer. The likelihood grid
+is over every combination of the mut values of all layers (rows) and the etaa values
+of all layers (columns), with the first layer varying slowest. For each mut and etaa
+of the chosen layer, profileLayer keeps the best likelihood over the parameters of
+the other layers, so that updateInterval and contour can work on one layer at a time.
+For a single layer, the profile is the likelihood grid itself. */
+
+/* Variables:
+    layer: The index of the layer to profile
+    mutStride, etaaStride: Distance in the likelihood grid between consecutive mut and
+        etaa values of the layer
+*/
+
+/******************************************************************************/
+
+void profileLayer( const vector<vector<double> >& likGrid, vector<vector<double> >& profile,
+    unsigned int layer, const vector<vector<double> >& mutVecs,
+    const vector<vector<double> >& etaaVecs ) {
+
+    unsigned int mutStride = 1, etaaStride = 1;
+    unsigned int mutN = mutVecs.at(layer).size(), etaaN = etaaVecs.at(layer).size();
+    unsigned int iL, jL;
+
+    for ( unsigned int l = layer + 1; l < mutVecs.size(); l++ ) {
+        mutStride *= mutVecs.at(l).size();
+        etaaStride *= etaaVecs.at(l).size();
+    }
+
+    profile.assign( mutN, vector<double>( etaaN, -numeric_limits<double>::infinity() ) );
+
+    for ( unsigned int i = 0; i < likGrid.size(); i++ ) {
+        iL = ( i / mutStride ) % mutN;
+        for ( unsigned int j = 0; j < likGrid.at(i).size(); j++ ) {
+            jL = ( j / etaaStride ) % etaaN;
+            if ( likGrid.at(i).at(j) > profile.at(iL).at(jL) ) {
+                profile.at(iL).at(jL) = likGrid.at(i).at(j);
+            }
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#include <vector>
+#include <limits>
+
+using namespace std;
+
+#pragma once
+
+void profileLayer( const vector<vector<double> >&, vector<vector<double> >&, unsigned int,
+    const vector<vector<double> >&, const vector<vector<double> >& );
@@ -20,6 +20,7 @@ int propagate( Particle &par ) {
 
 	double d, kz, z, minZ, maxZ;
 	int state;
+	COUNT_EVENT( par.counters.photonSteps++ );
 
 	/* Set d by exponential distribution */
 	d = newSegSize( par.sprngptr ) / ( par.lay.getMut() );
@@ -61,7 +62,7 @@ int propagate( Particle &par ) {
         }
 
         /* Update weight in boundary case */
-        par.weight.updateWtBound( par.lay.getMut(), d );
+        par.weight.updateWtBound( par.lay.getLayerNum(), d );
 
         /* Call boundary in main. */
         state = 3;
@@ -71,7 +72,7 @@ int propagate( Particle &par ) {
 
     else {
         /* Update weight in scatter case */
-        par.weight.updateWeightMut( par.lay.getMut(), d );
+        par.weight.updateWeightMut( par.lay.getLayerNum(), d );
 
         /* Call scatter in main. */
         state = 1;
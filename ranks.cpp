@@ -0,0 +1,108 @@
+#include "ranks.h"
+
+/* Ranks holds the message passing of a distributed run (MPI build, USE_MPI). Every rank
+sends its share of the particles of each forward run, with random number streams of its
+own, and reduce adds up the tallies of all ranks on rank 0 and sends the sums back, so
+that every rank scores the same ARS and finds the same search region. Decisions that
+depend on the clock of a rank are taken from rank 0 with fromRoot. Without USE_MPI, there
+is one rank and none of these functions do anything. */
+
+/******************************************************************************/
+
+/* Starts MPI. Only the master thread of each rank passes messages. */
+void Ranks::start() {
+#ifdef USE_MPI
+    int provided;
+    MPI_Init_thread( NULL, NULL, MPI_THREAD_FUNNELED, &provided );
+#endif
+}
+
+void Ranks::stop() {
+#ifdef USE_MPI
+    int finalized;
+    MPI_Finalized( &finalized );
+    if ( !finalized ) {
+        MPI_Finalize();
+    }
+#endif
+}
+
+unsigned int Ranks::rank() {
+#ifdef USE_MPI
+    int initialized, r;
+    MPI_Initialized( &initialized );
+    if ( initialized ) {
+        MPI_Comm_rank( MPI_COMM_WORLD, &r );
+        return r;
+    }
+#endif
+    return 0;
+}
+
+unsigned int Ranks::size() {
+#ifdef USE_MPI
+    int initialized, s;
+    MPI_Initialized( &initialized );
+    if ( initialized ) {
+        MPI_Comm_size( MPI_COMM_WORLD, &s );
+        return s;
+    }
+#endif
+    return 1;
+}
+
+/* Replaces the tally of every rank with the sum over all ranks (see the list form) */
+void Ranks::reduce( vector<vector<vector<double> > >& tally ) {
+    vector<vector<vector<vector<double> > >*> tallies( 1, &tally );
+    reduce( tallies );
+}
+
+/* Replaces each of tallies on every rank with its sum over all ranks. All of them are
+packed into one buffer and summed with one collective, as each collective costs a round
+of messages. The sum is made on rank 0 and sent to the others, so that all ranks have the
+same sum to the last bit. */
+void Ranks::reduce( const vector<vector<vector<vector<double> > >*>& tallies ) {
+#ifdef USE_MPI
+    if ( size() < 2 ) {
+        return;
+    }
+    vector<double> local, total;
+    for ( unsigned int t = 0; t < tallies.size(); t++ ) {
+        vector<vector<vector<double> > >& tally = *tallies.at(t);
+        for ( unsigned int i = 0; i < tally.size(); i++ ) {
+            for ( unsigned int j = 0; j < tally.at(i).size(); j++ ) {
+                local.insert( local.end(), tally.at(i).at(j).begin(), tally.at(i).at(j).end() );
+            }
+        }
+    }
+    total.assign( local.size(), 0 );
+    MPI_Reduce( local.data(), total.data(), local.size(), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD );
+    MPI_Bcast( total.data(), total.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD );
+
+    unsigned int k = 0;
+    for ( unsigned int t = 0; t < tallies.size(); t++ ) {
+        vector<vector<vector<double> > >& tally = *tallies.at(t);
+        for ( unsigned int i = 0; i < tally.size(); i++ ) {
+            for ( unsigned int j = 0; j < tally.at(i).size(); j++ ) {
+                for ( unsigned int m = 0; m < tally.at(i).at(j).size(); m++ ) {
+                    tally.at(i).at(j).at(m) = total.at(k++);
+                }
+            }
+        }
+    }
+#else
+    (void) tallies;
+#endif
+}
+
+/* Returns the value of decision on rank 0 to every rank */
+bool Ranks::fromRoot( bool decision ) {
+#ifdef USE_MPI
+    if ( size() > 1 ) {
+        int value = decision;
+        MPI_Bcast( &value, 1, MPI_INT, 0, MPI_COMM_WORLD );
+        return ( value != 0 );
+    }
+#endif
+    return decision;
+}
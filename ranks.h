@@ -0,0 +1,21 @@
+#include <vector>
+#include <iostream>
+
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+using namespace std;
+
+#pragma once
+
+class Ranks {
+    public:
+    static void start();
+    static void stop();
+    static unsigned int rank();
+    static unsigned int size();
+    static void reduce( vector<vector<vector<double> > >& );
+    static void reduce( const vector<vector<vector<vector<double> > >*>& );
+    static bool fromRoot( bool );
+};
@@ -0,0 +1,115 @@
+#include "readRequest.h"
+
+/* ReadRequest changes the defaults in setup to the values of one line of keywords,
+each followed by its values:
+    id name, n value, g value, t value, etaa min max N, mut min max N, particles N,
+    iterations N, radius value, seed value, exp path, ars v1 v2 ... vN
+where exp reads the experimental curve from a file, and ars, which must come last, gives
+it on the line. The lines are the requests of the daemon option and the jobs of the sweep
+option. ReadRequest returns FALSE if a keyword is unknown or its values could not be
+read. */
+
+/* Variables:
+    line: The keywords and values
+    setup: The setup to change, which holds the defaults
+    id: The name of the request, if it has one
+    seed: The seed of the random number generator, if the line has one
+*/
+
+/******************************************************************************/
+
+/* Creates count values from min to max, as setParameters does for the search grid */
+static bool readGrid( istream& in, vector<double>& grid ) {
+    double gridMin, gridMax;
+    unsigned int gridN;
+    in >> gridMin >> gridMax >> gridN;
+    if ( in.fail() || ( gridN < 2 ) || ( gridMax <= gridMin ) ) {
+        return false;
+    }
+    grid = gridVec( gridMin, gridMax, gridN );
+    return true;
+}
+
+bool readRequest( const string& line, InverseSetup& setup, string& id, int& seed ) {
+    istringstream in( line );
+    string key;
+    double value;
+    Layer& lay = setup.layerVec.at(0);
+
+    while ( in >> key ) {
+        bool valid = true;
+        if ( key == "id" ) {
+            in >> id;
+        }
+        else if ( key == "n" ) {
+            in >> value;
+            lay.setN( value );
+            valid = ( value >= 1 );
+        }
+        else if ( key == "g" ) {
+            in >> value;
+            lay.setG( value );
+            valid = ( value > -1 ) && ( value < 1 );
+        }
+        else if ( key == "t" ) {
+            in >> value;
+            lay.setZMax( lay.getZMin() + value );
+            valid = ( value > 0 );
+        }
+        else if ( key == "etaa" ) {
+            valid = readGrid( in, setup.etaaVec.at(0) );
+        }
+        else if ( key == "mut" ) {
+            valid = readGrid( in, setup.mutVec.at(0) );
+        }
+        else if ( key == "particles" ) {
+            in >> setup.numParticles;
+            valid = ( setup.numParticles > 0 );
+        }
+        else if ( key == "iterations" ) {
+            in >> setup.numIter;
+            valid = ( setup.numIter > 0 );
+        }
+        else if ( key == "radius" ) {
+            in >> setup.radius;
+        }
+        else if ( key == "seed" ) {
+            in >> seed;
+        }
+        else if ( key == "exp" ) {
+            string path;
+            in >> path;
+            setup.expData.clear();
+            fileToVec( setup.expData, path );
+            valid = ( setup.expData.size() > 0 );
+        }
+        else if ( key == "ars" ) {
+            setup.expData.clear();
+            while ( in >> value ) {
+                setup.expData.push_back( value );
+            }
+            valid = in.eof() && ( setup.expData.size() > 0 );
+            in.clear();
+            in.setstate( ios::eofbit );
+        }
+        else {
+            cerr << "Error: unknown request keyword " << key << " (in readRequest.cpp)." << endl;
+            return false;
+        }
+
+        if ( in.fail() || !valid ) {
+            cerr << "Error: could not read values of request keyword " << key
+                << " (in readRequest.cpp)." << endl;
+            return false;
+        }
+    }
+
+    /* The scanned indices must not be below n, as in the input file */
+    for ( unsigned int i = 0; i < setup.options.nGrid.size(); i++ ) {
+        if ( setup.options.nGrid.at(i) < lay.getN() ) {
+            cerr << "Error: nGrid values must not be below n (in readRequest.cpp)." << endl;
+            return false;
+        }
+    }
+    return true;
+}
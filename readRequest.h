@@ -0,0 +1,13 @@
+#include "fileToVec.h"
+#include "gridVec.h"
+#include "inverse.h"
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+#pragma once
+
+bool readRequest( const string&, InverseSetup&, string&, int& );
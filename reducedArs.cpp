@@ -0,0 +1,112 @@
+#include "reducedArs.h"
+
+/* ReducedArs is the compressed form of the fixed ARS over a grid, for the reducedBasis
+option. The ARS curves of neighboring grid points are nearly the same, so they are well
+described by a few basis curves. Build finds the basis from the eigenvectors of the
+covariance of the curves over the grid, which are the right singular vectors of the
+centered curves (a truncated SVD), and keeps only the coefficients of each curve. Score
+then evaluates the log-likelihood of scoreParam from the coefficients: with the projection
+p of the centered experimental curve onto the basis and the part e of it that is left
+over, the sum of squares of a curve with coefficients c is |p - c|^2 + |e|^2. This takes
+rank instead of N operations per grid point, once the experimental curve is projected.
+The basis is only worth building once for many scores, so it is built after each forward
+run of a batch, for all of its curves, or once when a library is written, which then only
+holds the mean, the basis and the coefficients (see arsLibrary.cpp). */
+
+/* Members:
+    rank: Number of basis curves
+    mean: The mean ARS curve over the grid
+    basis: The basis curves, one per column, orthonormal
+    coeffs: The coefficients of the ARS curve of each grid point
+*/
+
+/******************************************************************************/
+
+ReducedArs::ReducedArs() {
+    rank = 0;
+    mean.clear();
+    coeffs.clear();
+}
+
+/* Compresses the fixed ARS over an m by n grid to rankIn basis curves, at most the number
+of angles, and prints the part of the variance that is left out to progress. */
+void ReducedArs::build( const vector<vector<vector<double> > >& ars, unsigned int m, unsigned int n,
+    unsigned int rankIn, ostream& progress ) {
+    unsigned int N = ars.at(0).at(0).size();
+    rank = min( rankIn, N );
+
+    /* Mean curve and covariance of the curves over the grid */
+    mean.assign( N, 0 );
+    for ( unsigned int i = 0; i < m; i++ ) {
+        for ( unsigned int j = 0; j < n; j++ ) {
+            for ( unsigned int k = 0; k < N; k++ ) {
+                mean.at(k) += ars.at(i).at(j).at(k) / ( m*n );
+            }
+        }
+    }
+
+    MatrixXd cov = MatrixXd::Zero( N, N );
+    VectorXd d( N );
+    for ( unsigned int i = 0; i < m; i++ ) {
+        for ( unsigned int j = 0; j < n; j++ ) {
+            for ( unsigned int k = 0; k < N; k++ ) {
+                d(k) = ars.at(i).at(j).at(k) - mean.at(k);
+            }
+            cov += d * d.transpose();
+        }
+    }
+
+    /* The eigenvalues come in increasing order, so the basis is the last rank columns */
+    SelfAdjointEigenSolver<MatrixXd> eigen( cov );
+    basis = eigen.eigenvectors().rightCols( rank );
+    double lost = 1 - eigen.eigenvalues().tail( rank ).sum() / eigen.eigenvalues().sum();
+
+    coeffs.assign( m, vector<vector<double> >( n, vector<double>( rank ) ) );
+    for ( unsigned int i = 0; i < m; i++ ) {
+        for ( unsigned int j = 0; j < n; j++ ) {
+            for ( unsigned int k = 0; k < N; k++ ) {
+                d(k) = ars.at(i).at(j).at(k) - mean.at(k);
+            }
+            VectorXd c = basis.transpose() * d;
+            for ( unsigned int r = 0; r < rank; r++ ) {
+                coeffs.at(i).at(j).at(r) = c(r);
+            }
+        }
+    }
+
+    progress << "Reduced basis of " << rank << " curves leaves out " << setprecision( 3 ) << lost
+        << " of the ARS variance" << endl;
+}
+
+/* Evaluates the log-likelihood of every grid point against expData, like scoreParam.
+Returns FALSE if the experimental curve does not have the length of the ARS. */
+bool ReducedArs::score( vector<vector<double> >& likGrid, const vector<double>& expData ) const {
+    unsigned int N = mean.size();
+    if ( expData.size() != N ) {
+        cerr << "Error: vectors not the same size (from reducedArs.cpp)." << endl;
+        return false;
+    }
+
+    /* Project the experimental curve onto the basis */
+    VectorXd d( N );
+    for ( unsigned int k = 0; k < N; k++ ) {
+        d(k) = expData.at(k) - mean.at(k);
+    }
+    VectorXd p = basis.transpose() * d;
+    double perpSS = d.squaredNorm() - p.squaredNorm();
+    if ( perpSS < 0 ) {
+        perpSS = 0;
+    }
+    vector<double> expCoeffs( p.data(), p.data() + rank );
+
+    for ( unsigned int i = 0; i < coeffs.size(); i++ ) {
+        for ( unsigned int j = 0; j < coeffs.at(i).size(); j++ ) {
+            double l = likelihood( coeffs.at(i).at(j), expCoeffs, perpSS, N );
+            if ( l != l ) {
+                return false;
+            }
+            likGrid.at(i).at(j) = l;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,21 @@
+#include "likelihood.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <Dense>
+
+using namespace Eigen;
+using namespace std;
+
+#pragma once
+
+class ReducedArs {
+    public:
+    ReducedArs();
+    void build( const vector<vector<vector<double> > >&, unsigned int, unsigned int, unsigned int, ostream& );
+    bool score( vector<vector<double> >&, const vector<double>& ) const;
+    unsigned int rank;
+    vector<double> mean;
+    MatrixXd basis;
+    vector<vector<vector<double> > > coeffs;
+};
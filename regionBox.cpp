@@ -0,0 +1,39 @@
+#include "regionBox.h"
+
+/* RegionBox finds the discrete bounds of the next search region of every layer, the
+same way as updateInterval, but without changing the mut and etaa vectors. It is used
+to check the region after each round of a sequential forward run, so that the iteration
+can end as soon as the region no longer changes. RegionBox returns FALSE if the discrete
+maximum of a layer is on an edge of its grid. */
+
+/* Variables:
+    likGrid: The log-likelihood over the grid of all layers, after subFromMax
+    layerGrid: The profile log-likelihood of one layer
+    box: iMin, iMax, jMin and jMax of each layer in turn
+*/
+
+/******************************************************************************/
+
+bool regionBox( const vector<vector<double> >& likGrid, const vector<vector<double> >& mutVec,
+    const vector<vector<double> >& etaaVec, vector<int>& box ) {
+
+    vector<vector<double> > layerGrid;
+    box.clear();
+
+    for ( unsigned int l = 0; l < mutVec.size(); l++ ) {
+        int i0 = 0, j0 = 0, iMin, jMin;
+        int iMax = mutVec.at(l).size()-1, jMax = etaaVec.at(l).size()-1;
+
+        profileLayer( likGrid, layerGrid, l, mutVec, etaaVec );
+        if ( !discMax( layerGrid, i0, j0, mutVec.at(l).size(), etaaVec.at(l).size(), false ) ) {
+            return false;
+        }
+        findRegion( layerGrid, iMin, iMax, jMin, jMax, i0, j0 );
+
+        box.push_back( iMin );
+        box.push_back( iMax );
+        box.push_back( jMin );
+        box.push_back( jMax );
+    }
+    return true;
+}
@@ -0,0 +1,11 @@
+#include "discMax.h"
+#include "findRegion.h"
+#include "profileLayer.h"
+#include <vector>
+
+using namespace std;
+
+#pragma once
+
+bool regionBox( const vector<vector<double> >&, const vector<vector<double> >&,
+    const vector<vector<double> >&, vector<int>& );
@@ -35,10 +35,14 @@ bool roulette( Particle& par, int* sprngptr ) {
 
     /* Decide if particle survives */
     if ( x <= m ) {
+        COUNT_EVENT( par.counters.rouletteSurvivals++ );
+        COUNT_EVENT( par.counters.rouletteGained += par.weight.wScale * ( 1/m - 1 ) );
         par.weight.wScale /= m;
         return false;
     }
     else {
+        COUNT_EVENT( par.counters.rouletteKills++ );
+        COUNT_EVENT( par.counters.rouletteLost += par.weight.wScale );
         par.weight.wScale = 0;
         return true;
     }
@@ -0,0 +1,194 @@
+#include "runOptions.h"
+
+/* RunOptions holds the optional settings of a run. Optional settings follow the
+fixed parameters in the input file, one per line, as a keyword followed by its
+values. Every option defaults to the behavior of a run without it. */
+
+/* Members:
+    nGrid: Indices of refraction to reweight the final forward run to. Empty if the
+        index is not scanned. Keyword: nGrid nMin nMax nN
+    layers: Material and search parameters of each layer below the first, in input file
+        order. Keyword: layer n g t etaaMin etaaMax etaaN mutMin mutMax mutN
+    trustRadius: Starting trust radius of the trust region optimizer, as a fraction of the
+        search region. Zero for the grid search. Keyword: trustRegion radius
+    adaptTol: Relative change of the MLE between iterations below which the run stops
+        early. Zero for a fixed number of iterations, which doubles the particles every
+        time. Keyword: adaptive tol contourTol noise maxParticles
+    contourTol: Relative change of the contour area between iterations below which the run
+        stops early. The fitted Hessian is much noisier than the MLE, so it has its own tolerance
+    noiseTarget: Monte Carlo standard error of the MLE, relative to the MLE, that the
+        particle count of the next iteration is picked for
+    maxParticles: Most particles to send in one iteration of an adaptive run
+    rounds: Number of rounds to split each forward run into. The search region is checked
+        after each round, and the iteration ends early once it stops changing. One for a
+        single round. Keyword: sequential rounds
+    timeBudget: Wall-clock seconds the run may take. The run ends with the contour of the
+        particles so far once the next round would overrun it. Zero for no budget.
+        Keyword: timeBudget seconds
+    batchPath: File or directory of experimental ARS curves to fit together instead of
+        exp.txt. Empty for a single curve. Keyword: batch path
+    buildLibrary, libraryParticles, libraryBlocks: File to write the ARS over the search
+        grid to instead of fitting, the particles of the forward run of each sub-grid, and
+        the sub-grids along mu_t and eta_a. Keyword: buildLibrary path particles blocks
+    fitLibrary: Library file to fit from by interpolation, instead of running the forward
+        model. Keyword: fitLibrary path
+    reducedRank: Number of basis curves to compress the ARS over the grid of a batch or a
+        library to before it is scored. Zero to score the full ARS. Keyword: reducedBasis rank
+    daemonPath: Unix domain socket to answer fit requests on, or "-" for stdin, instead
+        of fitting exp.txt once. Empty for a single run. Keyword: daemon path
+    sweepPath: Job list to run together on one pool of threads, one job per line, instead
+        of fitting exp.txt once. Empty for a single run. Keyword: sweep path
+    checkpointPath, checkpointInterval: File to save the state of the run to, and the least
+        wall-clock seconds between two saves. Empty for no checkpoints.
+        Keyword: checkpoint path seconds
+    resume: Whether to go on from the checkpoint file instead of starting over. Set by the
+        --resume command line argument, not in the input file
+    tracePath: File to write a timeline of every thread to (Chrome trace JSON). Empty for
+        none. Keyword: trace path
+    floatBlock, floatCheck: Photons between two flushes of the single precision ARS tallies
+        of each stream into the double ones, zero for double tallies only, and whether to
+        also tally in double precision and report the difference. Keyword: floatTally block check
+    tileRecords: Escape records that the threads buffer between two flushes into one shared
+        ARS tally, split into a tile of the grid per thread, zero for a tally per batch.
+        Keyword: gridTiles records
+    pipeTally, pipeCapacity: Threads that only tally the escape records that the other
+        threads push to ring buffers, zero for threads that transport and tally, and the
+        records of each ring. Keyword: pipeline tallyThreads capacity
+    escapeLogPath: File to log every escaping photon of the last forward run to, for
+        tools/rebinLog. Empty for none. Keyword: escapeLog path
+    forwardPath: File to write the ARS and total reflectance and transmittance of a forward
+        run at the center of the search grid to, instead of fitting. Empty to fit.
+        Keyword: forward path
+*/
+
+/******************************************************************************/
+
+RunOptions::RunOptions() {
+    nGrid.clear();
+    layers.clear();
+    trustRadius = 0;
+    adaptTol = 0;
+    contourTol = 1;
+    noiseTarget = 0.01;
+    maxParticles = 0;
+    rounds = 1;
+    timeBudget = 0;
+    batchPath.clear();
+    buildLibrary.clear();
+    libraryParticles = 0;
+    libraryBlocks = 1;
+    fitLibrary.clear();
+    reducedRank = 0;
+    daemonPath.clear();
+    sweepPath.clear();
+    checkpointPath.clear();
+    checkpointInterval = 0;
+    resume = false;
+    tracePath.clear();
+    floatBlock = 0;
+    floatCheck = false;
+    tileRecords = 0;
+    pipeTally = 0;
+    pipeCapacity = 1024;
+    escapeLogPath.clear();
+    forwardPath.clear();
+}
+
+/* Reads the values of one option from the input stream. Returns FALSE if the keyword
+is unknown or its values could not be read. */
+bool RunOptions::readOption( const string& key, istream& in ) {
+    if ( key == "nGrid" ) {
+        double nMin, nMax;
+        unsigned int nN;
+        in >> nMin >> nMax >> nN;
+
+        nGrid = gridVec( nMin, nMax, nN );
+    }
+
+    else if ( key == "layer" ) {
+        vector<double> layerIn( 9 );
+        for ( unsigned int i = 0; i < layerIn.size(); i++ ) {
+            in >> layerIn.at(i);
+        }
+        layers.push_back( layerIn );
+    }
+
+    else if ( key == "trustRegion" ) {
+        in >> trustRadius;
+    }
+
+    else if ( key == "adaptive" ) {
+        in >> adaptTol >> contourTol >> noiseTarget >> maxParticles;
+    }
+
+    else if ( key == "sequential" ) {
+        in >> rounds;
+    }
+
+    else if ( key == "timeBudget" ) {
+        in >> timeBudget;
+    }
+
+    else if ( key == "batch" ) {
+        in >> batchPath;
+    }
+
+    else if ( key == "buildLibrary" ) {
+        in >> buildLibrary >> libraryParticles >> libraryBlocks;
+    }
+
+    else if ( key == "fitLibrary" ) {
+        in >> fitLibrary;
+    }
+
+    else if ( key == "reducedBasis" ) {
+        in >> reducedRank;
+    }
+
+    else if ( key == "daemon" ) {
+        in >> daemonPath;
+    }
+
+    else if ( key == "sweep" ) {
+        in >> sweepPath;
+    }
+
+    else if ( key == "checkpoint" ) {
+        in >> checkpointPath >> checkpointInterval;
+    }
+
+    else if ( key == "trace" ) {
+        in >> tracePath;
+    }
+
+    else if ( key == "floatTally" ) {
+        in >> floatBlock >> floatCheck;
+    }
+
+    else if ( key == "gridTiles" ) {
+        in >> tileRecords;
+    }
+
+    else if ( key == "pipeline" ) {
+        in >> pipeTally >> pipeCapacity;
+    }
+
+    else if ( key == "escapeLog" ) {
+        in >> escapeLogPath;
+    }
+
+    else if ( key == "forward" ) {
+        in >> forwardPath;
+    }
+
+    else {
+        cerr << "Error: unknown option " << key << " (from runOptions.cpp)." << endl;
+        return false;
+    }
+
+    if ( in.fail() ) {
+        cerr << "Error: could not read values of option " << key << " (from runOptions.cpp)." << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#include "gridVec.h"
+#include <vector>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+#pragma once
+
+class RunOptions {
+    public:
+    RunOptions();
+    bool readOption( const string&, istream& );
+    vector<double> nGrid;
+    vector<vector<double> > layers;
+    double trustRadius;
+    double adaptTol;
+    double contourTol;
+    double noiseTarget;
+    unsigned int maxParticles;
+    unsigned int rounds;
+    double timeBudget;
+    string batchPath;
+    string buildLibrary;
+    unsigned int libraryParticles;
+    unsigned int libraryBlocks;
+    string fitLibrary;
+    unsigned int reducedRank;
+    string daemonPath;
+    string sweepPath;
+    string checkpointPath;
+    double checkpointInterval;
+    bool resume;
+    string tracePath;
+    unsigned int floatBlock;
+    bool floatCheck;
+    unsigned int tileRecords;
+    unsigned int pipeTally;
+    unsigned int pipeCapacity;
+    string escapeLogPath;
+    string forwardPath;
+};
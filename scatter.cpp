@@ -26,7 +26,9 @@ int scatter( Particle &par ) {
 	const double TAU = 6.28318530717958647692;
 	const double WTH = 0.0001;
 
-    /* Update weight, since this counts as an event */
+    /* Update weight, since this counts as an event. The rest of the weight is absorbed. */
+    COUNT_EVENT( par.counters.scatters++ );
+    COUNT_EVENT( par.counters.absorbed += par.weight.wScale * ( 1 - par.lay.getMusDivMut() ) );
     par.updateWeightScatter();
 
     /* Call roulette if the weight is below the threshold. If roulette returns TRUE
@@ -7,13 +7,15 @@ by main before the forward and inverse for loops. SetParameters defines a
 stringstream to control which lines to include and which to ignore.
 SetParameters ignores everything after a tab or a #, and completely ignores
 contents of empty lines and lines that start with a #. This allows commenting
-in the input file. For now, the material is considered to be single-layer.
+in the input file. Any keyword lines after the fixed parameters are read as
+optional settings by RunOptions. The fixed parameters describe the first layer;
+each "layer" setting adds a layer below the previous ones.
 SetParameters returns TRUE if there is no file error and FALSE if there is,
 so that the program will close if there is a problem. */
 
 /* Variables:
-    layerVec: The layer object for the entire medium.
-    mut, etaa: The vectors that hold the mut and etaa values to test for likelihood
+    layerVec: The layer objects for the medium, starting with the layer particles enter
+    mut, etaa: The vectors that hold the mut and etaa values of each layer to test for likelihood
     nVal, gVal, zMax: Parameters of the medium
     etaaMin, etaaMax, etaaN, mutMin, mutMax, mutN: Range and number of etaa and mut to test
     numParticles, numTrials: number of particles to start with (forward) and number of search
@@ -21,19 +23,20 @@ so that the program will close if there is a problem. */
     numProc: Number of processors to use (parallelization)
     seedIn: Seed for random number generator (time(NULL) if zero)
     radius: Radius of detector (in experiment)
+    options: Optional settings, read from keyword lines after the fixed parameters
 
 */
 
 /******************************************************************************/
 
-bool setParameters( vector<Layer>& layerVec, vector<double>& mut, vector<double>& etaa,
+bool setParameters( vector<Layer>& layerVec, vector<vector<double> >& mut, vector<vector<double> >& etaa,
     unsigned int& numParticles, unsigned int& numTrials, unsigned int& numProc,
-    int& seedIn, double& radius ){
+    int& seedIn, double& radius, RunOptions& options ){
 
     ifstream paramFile( "dataIn/input.txt" );
     unsigned int etaaN, mutN;
     double nVal, gVal, zMax, etaaMin, etaaMax, mutMin, mutMax;
-    string line;
+    string line, key;
     stringstream l;
 
 /*********************  Read file to stringstream  ****************************/
@@ -76,6 +79,13 @@ bool setParameters( vector<Layer>& layerVec, vector<double>& mut, vector<double>
         l >> seedIn;
         l >> radius;
 
+        /* Read optional settings until the end of the stringstream */
+        while ( l >> key ) {
+            if ( !options.readOption( key, l ) ) {
+                return false;
+            }
+        }
+
         layerVec.at(0) = Layer( nVal, 1, 1, gVal, zMax );
         layerVec.at(0).setLayerNum(0);
     }
@@ -87,21 +97,192 @@ bool setParameters( vector<Layer>& layerVec, vector<double>& mut, vector<double>
         return false;
     }
 
-    /* Create etaa and mut vectors using defined N and range. */
-    for ( unsigned int i = 0; i < etaaN; i++ ) {
-        etaa.push_back( etaaMin + i * ( etaaMax-etaaMin ) / ( etaaN-1 ) );
-    }
+    paramFile.close();
 
-    for ( unsigned int i = 0; i < mutN; i++ ) {
-        mut.push_back( mutMin + i * ( mutMax - mutMin ) / ( mutN - 1 ) );
-    }
+    /* Stack the additional layers below the first. Each entry of options.layers is
+    (n, g, t, etaaMin, etaaMax, etaaN, mutMin, mutMax, mutN). */
+    mut.assign( 1 + options.layers.size(), vector<double>() );
+    etaa.assign( 1 + options.layers.size(), vector<double>() );
+    for ( unsigned int l = 0; l < mut.size(); l++ ) {
+        if ( l > 0 ) {
+            const vector<double>& layerIn = options.layers.at(l-1);
+            double zMin = layerVec.back().getZMax();
+            layerVec.push_back( Layer( layerIn.at(0), 1, 1, layerIn.at(1), zMin + layerIn.at(2) ) );
+            layerVec.back().setZMin( zMin );
+            layerVec.back().setLayerNum( l );
+            etaaMin = layerIn.at(3);
+            etaaMax = layerIn.at(4);
+            etaaN = layerIn.at(5);
+            mutMin = layerIn.at(6);
+            mutMax = layerIn.at(7);
+            mutN = layerIn.at(8);
+        }
 
-    paramFile.close();
+        /* Create etaa and mut vectors using defined N and range. */
+        etaa.at(l) = gridVec( etaaMin, etaaMax, etaaN );
+        mut.at(l) = gridVec( mutMin, mutMax, mutN );
+    }
 
     /* numProc is not defined when the file does not read properly */
     if ( numProc > 5000 ) {
         cerr << "File reading error (in setParameters.cpp)." << endl;
         return false;
     }
+
+    /* The reference run must be able to sample every reflection and transmission that
+    a scanned index can make, which fails below the reference index (see RunOptions). */
+    for ( unsigned int i = 0; i < options.nGrid.size(); i++ ) {
+        if ( options.nGrid.at(i) < nVal ) {
+            cerr << "Error: nGrid values must not be below n (in setParameters.cpp)." << endl;
+            return false;
+        }
+    }
+
+    /* The index weights only reweight the outer boundaries, so the layers must share n */
+    for ( unsigned int l = 1; l < layerVec.size() && options.nGrid.size() > 0; l++ ) {
+        if ( layerVec.at(l).getN() != nVal ) {
+            cerr << "Error: nGrid needs all layers to have the same n (in setParameters.cpp)." << endl;
+            return false;
+        }
+    }
+
+    /* The derivative tallies are for a single layer at a single index */
+    if ( ( options.trustRadius > 0 ) && ( ( layerVec.size() > 1 ) || ( options.nGrid.size() > 0 ) ) ) {
+        cerr << "Error: trustRegion needs a single layer and no nGrid (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* An adaptive run may stop before the last iteration, where the n scan and the final
+    trust region step happen */
+    if ( ( options.adaptTol > 0 ) && ( ( options.trustRadius > 0 ) || ( options.nGrid.size() > 0 ) ) ) {
+        cerr << "Error: adaptive needs no trustRegion and no nGrid (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    if ( ( options.adaptTol > 0 ) && ( ( options.contourTol <= 0 ) || ( options.noiseTarget <= 0 ) ||
+        ( options.maxParticles < numParticles ) ) ) {
+        cerr << "Error: adaptive needs a positive contour tolerance and noise target, and maxParticles "
+            << "of at least the number of particles (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A run out of time stops before the last iteration, where the n scan happens */
+    if ( ( options.timeBudget > 0 ) && ( options.nGrid.size() > 0 ) ) {
+        cerr << "Error: timeBudget needs no nGrid (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    if ( ( options.rounds < 1 ) || ( options.timeBudget < 0 ) ) {
+        cerr << "Error: sequential needs at least one round, and timeBudget may not be negative "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The curves of a batch share one grid of a single layer */
+    if ( ( options.batchPath.size() > 0 ) && ( ( layerVec.size() > 1 ) || ( options.nGrid.size() > 0 ) ||
+        ( options.trustRadius > 0 ) || ( options.adaptTol > 0 ) ) ) {
+        cerr << "Error: batch needs a single layer and no nGrid, trustRegion or adaptive "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The basis only pays off if it is built once for many scores: for the curves of a batch,
+    or for every fit from a library */
+    if ( ( options.reducedRank > 0 ) && options.batchPath.empty() && options.buildLibrary.empty() ) {
+        cerr << "Error: reducedBasis needs batch or buildLibrary (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A library holds the ARS of a single layer at one index, over one grid */
+    bool library = ( options.buildLibrary.size() > 0 ) || ( options.fitLibrary.size() > 0 );
+    if ( library && ( ( layerVec.size() > 1 ) || ( options.nGrid.size() > 0 ) || ( options.trustRadius > 0 ) ||
+        ( options.adaptTol > 0 ) || ( options.batchPath.size() > 0 ) ||
+        ( options.buildLibrary.size() > 0 && options.fitLibrary.size() > 0 ) ) ) {
+        cerr << "Error: buildLibrary and fitLibrary need a single layer and no nGrid, trustRegion, "
+            << "adaptive, batch or each other (in setParameters.cpp)." << endl;
+        return false;
+    }
+    if ( ( options.buildLibrary.size() > 0 ) && ( ( options.libraryParticles == 0 ) || ( options.libraryBlocks == 0 ) ) ) {
+        cerr << "Error: buildLibrary needs at least one particle and one sub-grid (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A request of the daemon changes the first layer and answers with one curve */
+    if ( ( options.daemonPath.size() > 0 ) && ( ( layerVec.size() > 1 ) || ( options.batchPath.size() > 0 ) ||
+        ( options.buildLibrary.size() > 0 ) ) ) {
+        cerr << "Error: daemon needs a single layer and no batch or buildLibrary "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A checkpoint holds the tallies and streams of a grid search in a single process */
+    if ( ( options.checkpointPath.size() > 0 ) && ( ( options.adaptTol > 0 ) || ( options.trustRadius > 0 ) ||
+        ( options.batchPath.size() > 0 ) || ( options.buildLibrary.size() > 0 ) || ( options.fitLibrary.size() > 0 ) ||
+        ( options.daemonPath.size() > 0 ) || ( options.sweepPath.size() > 0 ) || ( Ranks::size() > 1 ) ||
+        ( options.checkpointInterval < 0 ) ) ) {
+        cerr << "Error: checkpoint needs a grid search in one process, with no adaptive, trustRegion, "
+            << "batch, library, daemon or sweep option, and an interval of at least zero "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The daemon and the sweep answer from a single process */
+    if ( ( Ranks::size() > 1 ) && ( ( options.daemonPath.size() > 0 ) || ( options.sweepPath.size() > 0 ) ) ) {
+        cerr << "Error: daemon and sweep need a single MPI rank (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The jobs of a sweep are read like the requests of the daemon */
+    if ( ( options.sweepPath.size() > 0 ) && ( ( layerVec.size() > 1 ) || ( options.batchPath.size() > 0 ) ||
+        ( options.buildLibrary.size() > 0 ) || ( options.daemonPath.size() > 0 ) ) ) {
+        cerr << "Error: sweep needs a single layer and no batch, buildLibrary or daemon "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The double tally of the check is not saved in a checkpoint */
+    if ( options.floatCheck && ( ( options.floatBlock == 0 ) || ( options.checkpointPath.size() > 0 ) ) ) {
+        cerr << "Error: the check of floatTally needs a block of at least one photon and no checkpoint "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A trace is of one run, written when it ends */
+    if ( ( options.tracePath.size() > 0 ) && ( ( options.daemonPath.size() > 0 ) || ( options.sweepPath.size() > 0 ) ) ) {
+        cerr << "Error: trace needs no daemon or sweep (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The threads of the shared tally flush together, so each sends one batch, in a
+    parallel region of its own */
+    if ( ( options.tileRecords > 0 ) && ( ( options.adaptTol > 0 ) || ( options.floatBlock > 0 ) ||
+        ( options.sweepPath.size() > 0 ) ) ) {
+        cerr << "Error: gridTiles needs no adaptive, floatTally or sweep (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A pipeline needs a transport thread and a tally thread at least, in a parallel region
+    of its own */
+    if ( ( options.pipeTally > 0 ) && ( ( options.pipeTally >= numProc ) || ( options.pipeCapacity == 0 ) ||
+        ( options.floatBlock > 0 ) || ( options.tileRecords > 0 ) || ( options.sweepPath.size() > 0 ) ) ) {
+        cerr << "Error: pipeline needs fewer tally threads than processors, a capacity of at least one "
+            << "record and no floatTally, gridTiles or sweep (in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* The log is of the photons of one process since the start of the forward run */
+    if ( ( options.escapeLogPath.size() > 0 ) && ( ( options.checkpointPath.size() > 0 ) ||
+        ( options.daemonPath.size() > 0 ) || ( options.sweepPath.size() > 0 ) || ( Ranks::size() > 1 ) ) ) {
+        cerr << "Error: escapeLog needs no checkpoint, daemon or sweep, and a single MPI rank "
+            << "(in setParameters.cpp)." << endl;
+        return false;
+    }
+
+    /* A forward run at one point replaces the fit */
+    if ( ( options.forwardPath.size() > 0 ) && ( ( options.batchPath.size() > 0 ) || ( options.buildLibrary.size() > 0 ) ||
+        ( options.fitLibrary.size() > 0 ) || ( options.daemonPath.size() > 0 ) || ( options.sweepPath.size() > 0 ) ) ) {
+        cerr << "Error: forward needs no batch, library, daemon or sweep option (in setParameters.cpp)." << endl;
+        return false;
+    }
     return true;
 }
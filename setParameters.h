@@ -1,4 +1,7 @@
+#include "gridVec.h"
 #include "layer.h"
+#include "ranks.h"
+#include "runOptions.h"
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -9,5 +12,5 @@ using namespace std;
 
 #pragma once
 
-bool setParameters(vector<Layer>&, vector<double>&, vector<double>&,
-    unsigned int&, unsigned int&, unsigned int&, int&, double&);
+bool setParameters(vector<Layer>&, vector<vector<double> >&, vector<vector<double> >&,
+    unsigned int&, unsigned int&, unsigned int&, int&, double&, RunOptions&);
@@ -0,0 +1,126 @@
+#include "solver.h"
+
+/* Solver is the entry point of the program for other code that links the library
+(libmcslinv.a), and for the MCSLinv.x driver. It owns one random number stream per
+thread, so that several fits in a row continue the same streams, and runs the inverse
+algorithm or a single forward run on an InverseSetup. The setup and the results are
+passed in memory: nothing is read from dataIn or written to dataOut, unless an option
+of the setup names a file (batch, buildLibrary, fitLibrary). */
+
+/* Members:
+    numProc: Number of threads, and of random number streams
+    streams: The random number stream of each thread. NULL before init
+*/
+
+/******************************************************************************/
+
+Solver::Solver() {
+    numProc = 0;
+    streams = NULL;
+}
+
+Solver::~Solver() {
+    for ( unsigned int n = 0; n < numProc && streams; n++ ) {
+#ifdef SPRNGFIVE
+        streams[n]->free_sprng();
+#else
+        free_sprng( streams[n] );
+#endif
+    }
+#ifdef SPRNGFIVE
+    delete [] streams;
+#else
+    free( streams );
+#endif
+    streams = NULL;
+}
+
+/* Seeds the random number generator, depending on which version of SPRNG is present,
+and spawns one stream for each of threads threads. In an MPI run, the streams of each
+rank are spawned from a different stream. Returns FALSE if the streams could
+not be spawned, or if the solver already has streams. */
+bool Solver::init( unsigned int threads, int seed ) {
+    if ( streams ) {
+        cerr << "Error: the solver is already seeded (in solver.cpp)." << endl;
+        return false;
+    }
+    if ( threads < 1 ) {
+        cerr << "Error: the solver needs at least one thread (in solver.cpp)." << endl;
+        return false;
+    }
+
+#ifdef SPRNGFIVE
+    int gtype = 2;
+    Sprng *stream;
+    stream = SelectType(gtype);
+    stream->init_sprng(Ranks::rank(), Ranks::size(), seed, SPRNG_DEFAULT);
+
+    unsigned int nspawned = stream->spawn_sprng(threads,&streams);
+
+    if(nspawned != threads)
+    {
+        cerr <<  "Error: " << nspawned << " actual out of " << threads << " wanted streams spawned! (in solver.cpp)" << endl;
+        return false;
+    }
+#else
+    if ( !initSPRNG( threads, &streams, seed ) ) {
+        return false;
+    }
+#endif
+    numProc = threads;
+    return true;
+}
+
+/* Fits setup.expData (or the curve batch of setup) with the inverse algorithm on the
+threads of the solver, whatever setup.numProc is. The search grid of setup is narrowed
+to the last search region. Returns FALSE if there is an error. */
+bool Solver::inverse( InverseSetup& setup, InverseResult& result ) {
+    if ( !streams ) {
+        result.error = "the solver is not seeded";
+        cerr << "Error: " << result.error << " (in solver.cpp)." << endl;
+        return false;
+    }
+    setup.numProc = numProc;
+    setup.forwardOnly = false;
+    return ::inverse( setup, streams, result );
+}
+
+/* Runs the forward model once over the search grid of setup, with setup.numParticles
+particles, and leaves the ARS in result.ars without fitting. Only the size of
+setup.expData is used, for the number of angles. Returns FALSE if there is an error. */
+bool Solver::forward( InverseSetup& setup, InverseResult& result ) {
+    if ( !streams ) {
+        cerr << "Error: the solver is not seeded (in solver.cpp)." << endl;
+        return false;
+    }
+    setup.numProc = numProc;
+    setup.forwardOnly = true;
+    bool done = ::inverse( setup, streams, result );
+    setup.forwardOnly = false;
+    return done;
+}
+
+/* Runs the forward model at the center of the search grid of setup only, with scalar
+weights (see forwardPoint.cpp), and leaves the ARS and the total reflectance and
+transmittance in result. Returns FALSE if there is an error. */
+bool Solver::point( InverseSetup& setup, PointResult& result ) {
+    if ( !streams ) {
+        cerr << "Error: the solver is not seeded (in solver.cpp)." << endl;
+        return false;
+    }
+    setup.numProc = numProc;
+    return ::forwardPoint( setup, streams, result );
+}
+
+/* Returns the random number stream of thread n, for code that calls the transport
+functions itself (e.g. the benchmarks), or NULL if there is no such stream */
+#ifdef SPRNGFIVE
+Sprng* Solver::stream( unsigned int n ) {
+#else
+int* Solver::stream( unsigned int n ) {
+#endif
+    if ( !streams || ( n >= numProc ) ) {
+        return NULL;
+    }
+    return streams[n];
+}
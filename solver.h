@@ -0,0 +1,39 @@
+#include "initSPRNG.h"
+#include "forwardPoint.h"
+#include "inverse.h"
+#include <iostream>
+#include <cstdlib>
+#include "omp.h"
+
+#ifdef SPRNGFIVE
+#include "sprng_cpp.h"
+#endif
+
+using namespace std;
+
+#pragma once
+
+class Solver {
+    public:
+    Solver();
+    ~Solver();
+    bool init( unsigned int, int );
+    bool inverse( InverseSetup&, InverseResult& );
+    bool forward( InverseSetup&, InverseResult& );
+    bool point( InverseSetup&, PointResult& );
+    #ifdef SPRNGFIVE
+    Sprng* stream( unsigned int );
+    #else
+    int* stream( unsigned int );
+    #endif
+    unsigned int numProc;
+
+    private:
+    Solver( const Solver& );
+    Solver& operator=( const Solver& );
+    #ifdef SPRNGFIVE
+    Sprng** streams;
+    #else
+    int** streams;
+    #endif
+};
@@ -0,0 +1,158 @@
+#include "sweep.h"
+
+/* Sweep runs every job of a job list at once on one pool of numProc threads, instead of
+one inversion after the other. A job is one line of keywords followed by their values
+(see readRequest.cpp), and every value that is not given is taken from the input files.
+Each job is a task of the pool, and the chunks of particles of its forward runs are tasks
+too (see inverse.cpp), so threads that have no job left take over chunks of the jobs that
+are still running. Each job has numProc random number streams of its own, seeded with its
+seed, or with the seed of the input file plus its line number, so its result does not
+depend on how the pool runs it, and equals a single run with the same settings. The
+largest jobs are started first. Each job prints its progress to a stream of its own
+(setup.progress), so that the jobs share no stream state, and what failed in a job that
+fails is in its result. The other errors go to cerr, which is kept apart by thread (see
+threadLog.cpp); an error printed by a chunk task can therefore be logged under another job
+that ran on the same thread. The results and seconds of each job are written to
+dataOut/MCSLsweep.csv, and what each job printed to dataOut/MCSLsweep.log. Sweep returns FALSE if the job list could not be read. */
+
+/* Variables:
+    defaults: The setup from the input files, which every job starts from
+    seed: The seed of the input file
+    path: The job list. Empty lines and lines that start with # are skipped
+    setups, results, solvers: The setup, results and random number streams of each job
+    ids, seeds: The name and seed of each job
+    order: The jobs, largest first
+    jobProgress: The progress each job prints
+    log: The errors the threads print to cerr while the jobs run
+    ok, seconds, logs: Whether each job made a fit, its wall-clock time, and what it printed
+*/
+
+/******************************************************************************/
+
+bool sweep( const InverseSetup& defaults, int seed, const string& path ) {
+    ifstream jobFile( path.c_str() );
+    if ( !jobFile.is_open() ) {
+        cerr << "Error: job list " << path << " did not open (in sweep.cpp)." << endl;
+        return false;
+    }
+
+    /* Read every job before any of them runs */
+    vector<InverseSetup> setups;
+    vector<string> ids;
+    vector<int> seeds;
+    string line;
+    for ( unsigned int lineNum = 1; getline( jobFile, line ); lineNum++ ) {
+        if ( ( line.size() > 0 ) && ( line[line.size()-1] == '\r' ) ) {
+            line.resize( line.size()-1 );
+        }
+        if ( ( line.find_first_not_of( " \t" ) == string::npos ) || ( line[0] == '#' ) ) {
+            continue;
+        }
+        setups.push_back( defaults );
+        ids.push_back( to_string( lineNum ) );
+        seeds.push_back( seed + lineNum );
+        if ( !readRequest( line, setups.back(), ids.back(), seeds.back() ) ) {
+            cerr << "Error: could not read job on line " << lineNum << " of " << path
+                << " (in sweep.cpp)." << endl;
+            return false;
+        }
+    }
+    unsigned int numJobs = setups.size();
+    unsigned int numProc = defaults.numProc;
+    if ( numJobs == 0 ) {
+        cerr << "Error: job list " << path << " has no jobs (in sweep.cpp)." << endl;
+        return false;
+    }
+
+    /* Seed the streams of every job up front, since SPRNG is not seeded in parallel */
+    vector<Solver> solvers( numJobs );
+    for ( unsigned int j = 0; j < numJobs; j++ ) {
+        if ( !solvers.at(j).init( numProc, seeds.at(j) ) ) {
+            return false;
+        }
+    }
+
+    /* The particles of a job double every iteration */
+    vector<pair<double, unsigned int> > order;
+    for ( unsigned int j = 0; j < numJobs; j++ ) {
+        double size = setups.at(j).numParticles * pow( 2.0, setups.at(j).numIter ) *
+            setups.at(j).mutVec.at(0).size() * setups.at(j).etaaVec.at(0).size();
+        order.push_back( make_pair( -size, j ) );
+    }
+    sort( order.begin(), order.end() );
+
+/****************************  Run the jobs  **********************************/
+
+    vector<InverseResult> results( numJobs );
+    vector<bool> ok( numJobs, false );
+    vector<double> seconds( numJobs, 0 );
+    vector<string> logs( numJobs );
+    vector<ostringstream> jobProgress( numJobs );
+    for ( unsigned int j = 0; j < numJobs; j++ ) {
+        setups.at(j).progress = &jobProgress.at(j);
+    }
+    double wall0 = omp_get_wtime();
+
+    ThreadLog log( numProc );
+    streambuf* cerrBuf = cerr.rdbuf( &log );
+    omp_set_num_threads( numProc );
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+            for ( unsigned int k = 0; k < numJobs; k++ ) {
+                unsigned int j = order.at(k).second;
+
+                #pragma omp task firstprivate( j )
+                {
+                    unsigned int thread = omp_get_thread_num();
+                    double start = omp_get_wtime();
+                    log.take( thread );
+                    ok.at(j) = solvers.at(j).inverse( setups.at(j), results.at(j) );
+                    seconds.at(j) = omp_get_wtime() - start;
+                    logs.at(j) = jobProgress.at(j).str() + log.take( thread );
+                }
+            }
+        }
+    }
+
+    cerr.rdbuf( cerrBuf );
+    double total = omp_get_wtime() - wall0;
+
+/****************************  Save the results  ******************************/
+
+    ofstream saveData( "dataOut/MCSLsweep.csv" );
+    ofstream saveLog( "dataOut/MCSLsweep.log" );
+    if ( !saveData.is_open() || !saveLog.is_open() ) {
+        cerr << "File did not open (from sweep.cpp)." << endl;
+    }
+    saveData << "Seconds elapsed: " << total << " s" << endl;
+    saveData << "job, mu_s, mu_a, coeff eta_a^2, coeff eta_a mu_t, coeff mu_t^2, "
+        << "eta_a, mu_t, seconds, status" << endl;
+    for ( unsigned int j = 0; j < numJobs; j++ ) {
+        vector<double> p = ok.at(j) ? results.at(j).paramOut.at(0) : vector<double>( 5, 0 );
+        saveData << ids.at(j) << ", " << p.at(4)*(1-p.at(3)) << ", " << p.at(4)*p.at(3);
+        for ( unsigned int i = 0; i < p.size(); i++ ) {
+            saveData << ", " << p.at(i);
+        }
+        saveData << ", " << seconds.at(j) << ", " << ( ok.at(j) ? "ok" : "error" ) << endl;
+        saveLog << "Job " << ids.at(j) << ":" << endl << logs.at(j);
+        if ( !ok.at(j) ) {
+            saveLog << "Failed: " << results.at(j).error << endl;
+        }
+        saveLog << endl;
+
+        cout << "Job " << ids.at(j) << ": ";
+        if ( ok.at(j) ) {
+            cout << setprecision( 3 ) << "eta_a = " << p.at(3) << ", mu_t = " << p.at(4);
+        }
+        else {
+            cout << "error, " << results.at(j).error << " (see dataOut/MCSLsweep.log)";
+        }
+        cout << setprecision( 3 ) << ", " << seconds.at(j) << " s" << endl;
+    }
+    cout << "Sweep of " << numJobs << " jobs on " << numProc << " threads in " << setprecision( 3 )
+        << total << " s" << endl;
+    return true;
+}
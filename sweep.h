@@ -0,0 +1,18 @@
+#include "readRequest.h"
+#include "solver.h"
+#include "threadLog.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <math.h>
+#include "omp.h"
+
+using namespace std;
+
+#pragma once
+
+bool sweep( const InverseSetup&, int, const string& );
@@ -0,0 +1,37 @@
+#include "threadLog.h"
+
+/* ThreadLog is a stream buffer that keeps what each OpenMP thread writes apart, so that
+cerr can be pointed at it while several fits run at once, for the errors of code that has
+no stream of the fit to print to. A fit that runs as one tied task stays on its thread, so
+what the fit itself prints lands in the log of its thread. The chunk tasks of its forward
+runs may run on any thread of the pool, though, also on one that runs another fit, so an
+error printed by a chunk can end up in the log of that other fit. */
+
+/* Members:
+    logs: What each thread wrote since its log was last taken
+*/
+
+/******************************************************************************/
+
+ThreadLog::ThreadLog( unsigned int numThreads ) {
+    logs.assign( numThreads, string() );
+}
+
+/* Returns the log of thread, and starts it over */
+string ThreadLog::take( unsigned int thread ) {
+    string log;
+    log.swap( logs.at( thread ) );
+    return log;
+}
+
+int ThreadLog::overflow( int c ) {
+    if ( c != EOF ) {
+        logs.at( omp_get_thread_num() ) += (char) c;
+    }
+    return c;
+}
+
+streamsize ThreadLog::xsputn( const char* s, streamsize count ) {
+    logs.at( omp_get_thread_num() ).append( s, count );
+    return count;
+}
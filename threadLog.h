@@ -0,0 +1,21 @@
+#include <vector>
+#include <iostream>
+#include <string>
+#include "omp.h"
+
+using namespace std;
+
+#pragma once
+
+class ThreadLog : public streambuf {
+    public:
+    ThreadLog( unsigned int );
+    string take( unsigned int );
+
+    protected:
+    int overflow( int );
+    streamsize xsputn( const char*, streamsize );
+
+    private:
+    vector<string> logs;
+};
@@ -0,0 +1,132 @@
+#include "tiledTally.h"
+
+/* TiledTally is the ARS tally of the gridTiles option, which all threads of a forward run
+share instead of each batch having one of its own. A thread does not add the weight matrix
+of a photon it detects, but writes a compact escape record of it (angle index, wScale, and
+the collisions and path length in each layer) to its part of a shared buffer. Every
+perThread photons, all threads flush together: each evaluates the mut and etaa weight
+vectors of a share of the records, and then adds every record into its own tile of the
+grid, a range of the mut by etaa cells. No two threads write the same cell, so the tally
+needs no locks, and its memory, and that of the buffer, does not grow with the threads.
+Flush has barriers, so it must be called by every thread of the parallel region the same
+number of times. */
+
+/* Members:
+    ind, wScale: Angle index and scalar weight of each record, thread t having the records
+        from t*perThread
+    numColl, pathLen: Collisions and path length in each layer of each record
+    count, photons: Records and photons of each thread since the last flush
+    weightMut, weightEtaa: The mut weight vector (times wScale) and the etaa weight vector
+        of each record, evaluated in the flush
+    m, n, angleDiv: Size of the mut and etaa grids and number of angle divisions
+    layers, threads, perThread: Layers of the material, threads that share the tally, and
+        photons of each thread between two flushes
+*/
+
+/******************************************************************************/
+
+TiledTally::TiledTally() {
+    m = 0;
+    n = 0;
+    angleDiv = 0;
+    layers = 0;
+    threads = 1;
+    perThread = 1;
+}
+
+/* The buffer holds about records escape records in all, split evenly among the threads */
+TiledTally::TiledTally( unsigned int mIn, unsigned int nIn, unsigned int angleDivIn, unsigned int layersIn,
+    unsigned int threadsIn, unsigned int records ) {
+    m = mIn;
+    n = nIn;
+    angleDiv = angleDivIn;
+    layers = layersIn;
+    threads = threadsIn;
+    perThread = ( records + threads - 1 ) / threads;
+    if ( perThread == 0 ) {
+        perThread = 1;
+    }
+    unsigned int size = threads * perThread;
+    ind.assign( size, 0 );
+    wScale.assign( size, 0 );
+    numColl.assign( size * layers, 0 );
+    pathLen.assign( size * layers, 0 );
+    weightMut.assign( (unsigned long long) size * m, 0 );
+    weightEtaa.assign( (unsigned long long) size * n, 0 );
+    count.assign( threads, 0 );
+    photons.assign( threads, 0 );
+}
+
+/* Writes the escape record of a photon of thread detected at angle index indIn */
+void TiledTally::record( unsigned int thread, const Weight& weight, unsigned int indIn ) {
+    unsigned int r = thread * perThread + count.at(thread)++;
+    ind.at(r) = indIn;
+    wScale.at(r) = weight.wScale;
+    for ( unsigned int l = 0; l < layers; l++ ) {
+        numColl.at( r*layers + l ) = weight.numColl.at(l);
+        pathLen.at( r*layers + l ) = weight.pathLen.at(l);
+    }
+}
+
+/* Counts a photon of thread, whether it was detected or not */
+void TiledTally::endPhoton( unsigned int thread ) {
+    photons.at(thread)++;
+}
+
+/* Whether thread has sent perThread photons and the tally has to be flushed */
+bool TiledTally::full( unsigned int thread ) const {
+    return photons.at(thread) >= perThread;
+}
+
+/* Adds the records of all threads into ars. Called by every thread with its number and a
+weight object to evaluate the weight vectors with. */
+void TiledTally::flush( unsigned int thread, Weight& weight, vector<vector<vector<double> > >& ars ) {
+
+    /* Evaluate the weight vectors of every threads-th record */
+    #pragma omp barrier
+    unsigned int k = 0;
+    for ( unsigned int t = 0; t < threads; t++ ) {
+        for ( unsigned int c = 0; c < count.at(t); c++, k++ ) {
+            if ( k % threads != thread ) {
+                continue;
+            }
+            unsigned int r = t * perThread + c;
+            for ( unsigned int l = 0; l < layers; l++ ) {
+                weight.numColl.at(l) = numColl.at( r*layers + l );
+                weight.pathLen.at(l) = pathLen.at( r*layers + l );
+            }
+            weight.updateVectors();
+            for ( unsigned int i = 0; i < m; i++ ) {
+                weightMut[ (unsigned long long) r*m + i ] = weight.weightMut[i] * wScale.at(r);
+            }
+            for ( unsigned int j = 0; j < n; j++ ) {
+                weightEtaa[ (unsigned long long) r*n + j ] = weight.weightEtaa[j];
+            }
+        }
+    }
+
+    /* Add every record into the cells of the tile of this thread */
+    #pragma omp barrier
+    unsigned long long cells = (unsigned long long) m * n;
+    unsigned long long c0 = cells * thread / threads, c1 = cells * ( thread+1 ) / threads;
+    for ( unsigned int t = 0; t < threads && c0 < c1; t++ ) {
+        for ( unsigned int c = 0; c < count.at(t); c++ ) {
+            unsigned int r = t * perThread + c;
+            const double* mutW = &weightMut[ (unsigned long long) r*m ];
+            const double* etaaW = &weightEtaa[ (unsigned long long) r*n ];
+            unsigned int i = c0 / n, j = c0 % n, a = ind[r];
+            for ( unsigned long long cell = c0; cell < c1; cell++ ) {
+                ars[i][j][a] += mutW[i] * etaaW[j];
+                if ( ++j == n ) {
+                    j = 0;
+                    i++;
+                }
+            }
+        }
+    }
+
+    /* The records are only cleared once every thread has added them */
+    #pragma omp barrier
+    count.at(thread) = 0;
+    photons.at(thread) = 0;
+}
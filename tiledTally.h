@@ -0,0 +1,23 @@
+#include "weight.h"
+#include <vector>
+#include <iostream>
+#include "omp.h"
+
+using namespace std;
+
+#pragma once
+
+class TiledTally {
+    public:
+    TiledTally();
+    TiledTally( unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int );
+    void record( unsigned int, const Weight&, unsigned int );
+    void endPhoton( unsigned int );
+    bool full( unsigned int ) const;
+    void flush( unsigned int, Weight&, vector<vector<vector<double> > >& );
+
+    private:
+    vector<unsigned int> ind, numColl, count, photons;
+    vector<double> wScale, pathLen, weightMut, weightEtaa;
+    unsigned int m, n, angleDiv, layers, threads, perThread;
+};
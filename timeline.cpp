@@ -0,0 +1,77 @@
+#include "timeline.h"
+
+/* Timeline records spans of time on each thread (trace option): the photons of each batch
+on the thread that sent them, and the phases and iterations of the inverse algorithm on the
+thread that runs it (see phaseTimer.cpp). Each thread appends to a buffer of its own, so
+no locks are taken, and the buffers are padded so that two threads do not share a cache
+line. write saves the spans in the Chrome trace format (JSON), which chrome://tracing and
+Perfetto show as one row per thread, so idle threads and serial phases show as gaps. */
+
+/* Members:
+    on: Whether spans are recorded. Set by start.
+    buffers: The spans of each thread, by omp thread number
+    origin: The time that the times of the spans are counted from
+*/
+
+/******************************************************************************/
+
+Timeline::Timeline() {
+    on = false;
+    buffers.clear();
+    origin = chrono::steady_clock::now();
+}
+
+/* Starts recording, with a buffer for each thread of the next parallel loops */
+void Timeline::start() {
+    buffers.assign( omp_get_max_threads(), Buffer() );
+    origin = chrono::steady_clock::now();
+    on = true;
+}
+
+/* Returns the seconds since start */
+double Timeline::now() const {
+    return chrono::duration<double>( chrono::steady_clock::now() - origin ).count();
+}
+
+/* Adds the span name from begin to end (seconds since start) to the buffer of the calling
+thread. args are the members of a JSON object shown with the span, and may be empty. */
+void Timeline::add( const string& name, double begin, double end, const string& args ) {
+    unsigned int thread = omp_get_thread_num();
+    if ( !on || ( thread >= buffers.size() ) ) {
+        return;
+    }
+    Span span;
+    span.name = name;
+    span.args = args;
+    span.begin = begin;
+    span.end = end;
+    buffers.at( thread ).spans.push_back( span );
+}
+
+/* Writes all spans to path as a Chrome trace, with process number pid (the MPI rank) and
+one thread per buffer. Returns FALSE if the file did not open. */
+bool Timeline::write( const string& path, unsigned int pid ) const {
+    ofstream saveData( path.c_str() );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from timeline.cpp)." << endl;
+        return false;
+    }
+
+    saveData << "{\"traceEvents\": [" << endl;
+    saveData << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": 0, "
+        << "\"args\": {\"name\": \"MCSLinv rank " << pid << "\"}}";
+    saveData.setf( ios::fixed );
+    saveData.precision( 3 );
+    for ( unsigned int t = 0; t < buffers.size(); t++ ) {
+        saveData << "," << endl << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": "
+            << t << ", \"args\": {\"name\": \"thread " << t << "\"}}";
+        for ( unsigned int k = 0; k < buffers.at(t).spans.size(); k++ ) {
+            const Span& span = buffers.at(t).spans.at(k);
+            saveData << "," << endl << "{\"name\": \"" << span.name << "\", \"ph\": \"X\", \"pid\": " << pid
+                << ", \"tid\": " << t << ", \"ts\": " << 1e6 * span.begin << ", \"dur\": "
+                << 1e6 * ( span.end - span.begin ) << ", \"args\": {" << span.args << "}}";
+        }
+    }
+    saveData << endl << "], \"displayTimeUnit\": \"ms\"}" << endl;
+    return true;
+}
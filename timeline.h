@@ -0,0 +1,32 @@
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include "omp.h"
+
+using namespace std;
+
+#pragma once
+
+class Timeline {
+    public:
+    Timeline();
+    void start();
+    double now() const;
+    void add( const string&, double, double, const string& );
+    bool write( const string&, unsigned int ) const;
+    bool on;
+
+    private:
+    struct Span {
+        string name, args;
+        double begin, end;
+    };
+    struct Buffer {
+        vector<Span> spans;
+        char pad[64];
+    };
+    vector<Buffer> buffers;
+    chrono::steady_clock::time_point origin;
+};
@@ -0,0 +1,141 @@
+#include "escapeLog.h"
+#include "addVec.h"
+#include "fixARS.h"
+#include "gridVec.h"
+#include "intersect.h"
+#include "weight.h"
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "omp.h"
+
+using namespace std;
+
+/* RebinLog tallies the ARS again from the escape log of a run (escapeLog option), for a
+detector radius, a number of angles and a search grid that may differ from those of the
+run, without simulating any photon. The log is mapped into memory, and its chunks are
+shared out among the threads, which move each photon onto the new detector sphere, bin its
+angle, and add its importance sampling weights over the new grid (relative to the
+reference mut and etaa of the run, from the log) the way detect does. The ARS is then
+normalized and flipped by fixARS, like the ARS of the run, and written to a CSV file with
+one row per grid point: the mu_t and eta_a of each layer, and the ARS at each angle. The
+new grid should stay near the reference values of the run, as importance sampling far from
+them is noisy. With the radius, angles and grid of the run, it gives the ARS of the run.
+
+Usage: rebinLog log out.csv radius angles mutMin mutMax mutN etaaMin etaaMax etaaN, with
+the last six values once per layer of the log. A radius or angles of 0 keeps the one of
+the run. Built with make tools. */
+
+/* Variables:
+    log: The mapped escape log
+    radius, angleDiv: Detector radius, and divisions of the angle (twice the angles)
+    mutVec, etaaVec: The new mu_t and eta_a grid of each layer
+    mutSize, etaaSize: Combinations of the mu_t and eta_a over all layers
+    arsProc, ars: The ARS of each thread, and of all of them
+*/
+
+/******************************************************************************/
+
+int main( int argc, char* argv[] ) {
+    const double PI = 3.14159265358979323846;
+    EscapeLog log;
+    if ( ( argc < 11 ) || !log.map( argv[1] ) ) {
+        cerr << "Usage: rebinLog log out.csv radius angles mutMin mutMax mutN etaaMin etaaMax etaaN "
+            << "(the last six once per layer)." << endl;
+        return 1;
+    }
+    if ( (unsigned int) argc != 5 + 6 * log.layers ) {
+        cerr << "Error: the log has " << log.layers << " layers, which need " << 6 * log.layers
+            << " grid values (in rebinLog.cpp)." << endl;
+        return 1;
+    }
+
+    double radius = ( atof( argv[3] ) > 0 ) ? atof( argv[3] ) : log.radius;
+    unsigned int angleDiv = ( atoi( argv[4] ) > 0 ) ? 2 * atoi( argv[4] ) : log.angleDiv;
+    vector<vector<double> > mutVec, etaaVec;
+    unsigned int mutSize = 1, etaaSize = 1;
+    for ( unsigned int l = 0; l < log.layers; l++ ) {
+        char** value = argv + 5 + 6*l;
+        mutVec.push_back( gridVec( atof( value[0] ), atof( value[1] ), atoi( value[2] ) ) );
+        etaaVec.push_back( gridVec( atof( value[3] ), atof( value[4] ), atoi( value[5] ) ) );
+        mutSize *= mutVec.back().size();
+        etaaSize *= etaaVec.back().size();
+    }
+    if ( mutSize * etaaSize == 0 ) {
+        cerr << "Error: the grid of every layer needs at least one point (in rebinLog.cpp)." << endl;
+        return 1;
+    }
+
+    /* Tally the photons of each chunk like detect */
+    vector<vector<vector<double> > > ars( mutSize, vector<vector<double> >( etaaSize, vector<double>( angleDiv, 0 ) ) );
+    vector<vector<vector<vector<double> > > > arsProc( omp_get_max_threads(), ars );
+    unsigned int stride = log.recordSize();
+    #pragma omp parallel for schedule(dynamic)
+    for ( unsigned int c = 0; c < log.chunkStart.size(); c++ ) {
+        vector<vector<vector<double> > >& tally = arsProc.at( omp_get_thread_num() );
+        Weight weight( mutVec, etaaVec );
+        weight.mutRef = log.mutRef;
+        weight.etaaRef = log.etaaRef;
+        vector<double> rVec( 3 ), dir( 3 );
+        for ( unsigned long long k = 0; k < log.chunkCount.at(c); k++ ) {
+            const double* record = log.chunkStart.at(c) + k * stride;
+            rVec.assign( record, record + 3 );
+            dir.assign( record + 3, record + 6 );
+            weight.wScale = record[6];
+            for ( unsigned int l = 0; l < log.layers; l++ ) {
+                weight.numColl.at(l) = (unsigned int) record[ 7 + 2*l ];
+                weight.pathLen.at(l) = record[ 8 + 2*l ];
+            }
+
+            unsigned int ind = int( angleDiv * intersect( radius, rVec, dir ) / PI );
+            if ( ind >= angleDiv ) {
+                ind = angleDiv - 1;
+            }
+            weight.updateMatrix();
+            for ( unsigned int i = 0; i < mutSize; i++ ) {
+                for ( unsigned int j = 0; j < etaaSize; j++ ) {
+                    tally.at(i).at(j).at(ind) += weight.weightMatrix.at(i).at(j);
+                }
+            }
+        }
+    }
+    for ( unsigned int p = 0; p < arsProc.size(); p++ ) {
+        addVec( ars, arsProc.at(p), mutSize, etaaSize );
+    }
+    fixARS( ars, log.photons, mutSize, etaaSize );
+
+    /* One row per grid point, the first layer varying slowest */
+    ofstream saveData( argv[2] );
+    if ( !saveData.is_open() ) {
+        cerr << "File did not open (from rebinLog.cpp)." << endl;
+        return 1;
+    }
+    for ( unsigned int l = 0; l < log.layers; l++ ) {
+        saveData << "mu_t " << l+1 << ",eta_a " << l+1 << ",";
+    }
+    saveData << "ARS (" << angleDiv/2 << " angles, radius " << radius << ", " << log.photons << " photons)" << endl;
+    saveData << setprecision( 10 );
+    for ( unsigned int i = 0; i < mutSize; i++ ) {
+        for ( unsigned int j = 0; j < etaaSize; j++ ) {
+            unsigned int mi = i, ej = j;
+            vector<double> mut( log.layers ), etaa( log.layers );
+            for ( int l = log.layers - 1; l >= 0; l-- ) {
+                mut.at(l) = mutVec.at(l).at( mi % mutVec.at(l).size() );
+                etaa.at(l) = etaaVec.at(l).at( ej % etaaVec.at(l).size() );
+                mi /= mutVec.at(l).size();
+                ej /= etaaVec.at(l).size();
+            }
+            for ( unsigned int l = 0; l < log.layers; l++ ) {
+                saveData << mut.at(l) << "," << etaa.at(l) << ",";
+            }
+            for ( unsigned int b = 0; b < ars.at(i).at(j).size(); b++ ) {
+                saveData << ars.at(i).at(j).at(b) << ( b+1 < ars.at(i).at(j).size() ? "," : "" );
+            }
+            saveData << endl;
+        }
+    }
+    cout << "Tallied " << log.photons << " photons (" << log.chunkStart.size() << " chunks) over " << mutSize
+        << " x " << etaaSize << " grid points to " << argv[2] << endl;
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include "trustRegion.h"
+
+/* TrustRegion is the optimizer that replaces the grid search when the trustRegion
+option is set. Each iteration of the control loop simulates particles at the trial
+point and tallies the ARS and its first and second derivatives there (detectDeriv),
+along with the ARS at the incumbent point, which is the best point so far. Update
+turns these into the log-likelihood of likelihood.cpp at both points and its gradient
+and Hessian at the trial point. It accepts the trial point if the log-likelihood
+improved by enough compared to the quadratic model, updates the trust radius, and
+takes a Newton step from the incumbent that is limited to the trust radius. On the
+last iteration, update returns the Hessian and the Newton maximum in the same form as
+contour, so that the output and the confidence ellipse do not change. */
+
+/* Members:
+    etaaTrial, mutTrial: The point to simulate particles at in the next iteration
+    etaaInc, mutInc: The incumbent point, which has the best log-likelihood so far
+    radius: The trust radius, in units of etaaScale and mutScale
+    predicted: Increase in log-likelihood predicted by the model for the last step
+    stepNorm: Length of the last step, in units of etaaScale and mutScale
+    etaaScale, mutScale: Width of the starting search region, to scale the two parameters
+    grad: Gradient of the log-likelihood at the incumbent, (etaa, mut)
+    hess: Hessian of the log-likelihood at the incumbent, (etaa etaa, etaa mut, mut mut)
+    stepTaken: FALSE until the first step is taken, so that there is no step to judge
+*/
+
+/******************************************************************************/
+
+TrustRegion::TrustRegion() {
+    etaaTrial = etaaInc = 0.1;
+    mutTrial = mutInc = 1;
+    etaaScale = mutScale = 1;
+    radius = 0.25;
+    predicted = stepNorm = 0;
+    grad.assign( 2, 0 );
+    hess.assign( 3, 0 );
+    stepTaken = false;
+}
+
+/* Overload constructor: starts at (etaa, mut), with the trust radius a fraction of the
+search region. */
+TrustRegion::TrustRegion( double etaa, double mut, double etaaWidth, double mutWidth,
+    double radiusIn ) {
+    etaaTrial = etaaInc = etaa;
+    mutTrial = mutInc = mut;
+    etaaScale = etaaWidth;
+    mutScale = mutWidth;
+    radius = radiusIn;
+    predicted = stepNorm = 0;
+    grad.assign( 2, 0 );
+    hess.assign( 3, 0 );
+    stepTaken = false;
+}
+
+/* Judges the last step and takes the next one. deriv holds the fixed ARS derivative
+tallies at the trial point, in the order of detectDeriv, and incARS the fixed ARS at the
+incumbent. Returns FALSE if the log-likelihood could not be evaluated or, on the last
+iteration, if the Hessian does not have a maximum. The steps are printed to progress. */
+bool TrustRegion::update( const vector<vector<vector<double> > >& deriv,
+    const vector<double>& incARS, const vector<double>& expData, bool last,
+    vector<double>& storeParab, ostream& progress ) {
+
+    unsigned int N = expData.size();
+    double halfN = N/2.0;
+    double r, rInc, ssT = 0, ssInc = 0, rho = 0;
+    double de, dm, dssE = 0, dssM = 0, d2ssEE = 0, d2ssEM = 0, d2ssMM = 0;
+
+    if ( ( deriv.at(0).at(0).size() != N ) || ( incARS.size() != N ) ) {
+        cerr << "Error: vectors not the same size (from trustRegion.cpp)." << endl;
+        return false;
+    }
+
+    /* Sum of squares, as in likelihood.cpp, and its derivatives */
+    for ( unsigned int b = 0; b < N; b++ ) {
+        r = deriv.at(0).at(0).at(b) - expData.at(b);
+        rInc = incARS.at(b) - expData.at(b);
+        dm = deriv.at(1).at(0).at(b);
+        de = deriv.at(2).at(0).at(b);
+        ssT += r*r;
+        ssInc += rInc*rInc;
+        dssE += 2*r*de;
+        dssM += 2*r*dm;
+        d2ssEE += 2*( de*de + r*deriv.at(5).at(0).at(b) );
+        d2ssEM += 2*( de*dm + r*deriv.at(4).at(0).at(b) );
+        d2ssMM += 2*( dm*dm + r*deriv.at(3).at(0).at(b) );
+    }
+
+    /* Log-likelihood = -N/2 log( SS/N ), up to a constant */
+    double lTrial = -halfN * log( ssT / N );
+    double lInc = -halfN * log( ssInc / N );
+    vector<double> g( 2 ), h( 3 );
+    g.at(0) = -halfN * dssE / ssT;
+    g.at(1) = -halfN * dssM / ssT;
+    h.at(0) = -halfN * ( d2ssEE / ssT - dssE*dssE / ( ssT*ssT ) );
+    h.at(1) = -halfN * ( d2ssEM / ssT - dssE*dssM / ( ssT*ssT ) );
+    h.at(2) = -halfN * ( d2ssMM / ssT - dssM*dssM / ( ssT*ssT ) );
+
+    /* l!=l catches nan's */
+    if ( ( lTrial != lTrial ) || ( lInc != lInc ) || ( h.at(0) != h.at(0) ) ) {
+        cerr << "Error: log-likelihood is not a number (from trustRegion.cpp)." << endl;
+        return false;
+    }
+
+/***********************  Judge the last step  ********************************/
+
+    if ( stepTaken ) {
+        rho = ( predicted > 0 ) ? ( lTrial - lInc ) / predicted : 1;
+    }
+
+    /* Accept the trial point, or the starting point before any step */
+    if ( !stepTaken || ( rho > 0.1 ) ) {
+        etaaInc = etaaTrial;
+        mutInc = mutTrial;
+        grad = g;
+        hess = h;
+        if ( stepTaken && ( rho < 0.25 ) ) {
+            radius = 0.25 * stepNorm;
+        }
+        else if ( stepTaken && ( rho > 0.75 ) && ( stepNorm > 0.99 * radius ) ) {
+            radius *= 2;
+        }
+    }
+
+    /* Reject the trial point and keep the incumbent and its model */
+    else {
+        radius = 0.25 * stepNorm;
+    }
+
+    progress << "eta_a: " << setprecision( 3 ) << etaaInc << ", mu_t: " << setprecision( 3 )
+        << mutInc << ( ( stepTaken && ( rho <= 0.1 ) ) ? " (step rejected)" : "" ) << endl;
+
+/********************  End of judging the last step  **************************/
+
+    /* On the last iteration, return the Hessian and the maximum of the model */
+    if ( last ) {
+        storeParab.at(0) = hess.at(0);
+        storeParab.at(1) = hess.at(1);
+        storeParab.at(2) = hess.at(2);
+        if ( !checkEigenVals( storeParab, true ) ) {
+            return false;
+        }
+        double det = hess.at(0)*hess.at(2) - hess.at(1)*hess.at(1);
+        storeParab.at(3) = etaaInc - ( hess.at(2)*grad.at(0) - hess.at(1)*grad.at(1) ) / det;
+        storeParab.at(4) = mutInc - ( hess.at(0)*grad.at(1) - hess.at(1)*grad.at(0) ) / det;
+        progress << "eta_a = " << storeParab.at(3) << endl;
+        progress << "mu_t = " << storeParab.at(4) << endl << endl;
+        return true;
+    }
+
+    takeStep();
+    progress << "trust radius: " << setprecision( 3 ) << radius << endl << endl;
+    return true;
+}
+
+/* Takes the step from the incumbent that maximizes the quadratic model within the trust
+radius. In scaled units, the step p solves (B + lambda I) p = g with B = -hess, where
+lambda is zero if the Newton step fits in the trust region, and otherwise is found by
+bisection so that the step has the length of the trust radius. */
+void TrustRegion::takeStep() {
+    double gE = grad.at(0) * etaaScale, gM = grad.at(1) * mutScale;
+    double bEE = -hess.at(0) * etaaScale * etaaScale;
+    double bEM = -hess.at(1) * etaaScale * mutScale;
+    double bMM = -hess.at(2) * mutScale * mutScale;
+    double tr = bEE + bMM, det = bEE*bMM - bEM*bEM;
+    double lambdaMin = tr/2 - sqrt( fabs( tr*tr/4 - det ) );
+    double lambda = 0, lo, hi, pE = 0, pM = 0, d;
+
+    /* Step for a given lambda (a zero step if the system is singular) */
+    for ( int i = 0; i < 200; i++ ) {
+        d = ( bEE + lambda ) * ( bMM + lambda ) - bEM*bEM;
+        pE = ( d > 0 ) ? ( ( bMM + lambda ) * gE - bEM * gM ) / d : 0;
+        pM = ( d > 0 ) ? ( ( bEE + lambda ) * gM - bEM * gE ) / d : 0;
+
+        /* The Newton step is taken if the model has a maximum inside the trust region */
+        if ( ( i == 0 ) && ( lambdaMin > 0 ) && ( sqrt( pE*pE + pM*pM ) <= radius ) ) {
+            break;
+        }
+
+        /* Otherwise bracket and bisect on the length of the step */
+        if ( i == 0 ) {
+            lo = ( lambdaMin < 0 ) ? -lambdaMin : 0;
+            hi = lo + sqrt( gE*gE + gM*gM ) / radius + 1e-12;
+        }
+        else if ( ( d <= 0 ) || ( sqrt( pE*pE + pM*pM ) > radius ) ) {
+            lo = lambda;
+        }
+        else {
+            hi = lambda;
+        }
+        if ( ( i > 0 ) && ( hi - lo <= 1e-12 * hi ) ) {
+            break;
+        }
+        lambda = ( lo + hi ) / 2;
+    }
+
+    /* Keep etaa between 0 and 1 and mut positive */
+    while ( ( etaaInc + pE*etaaScale <= 0 ) || ( etaaInc + pE*etaaScale >= 1 )
+        || ( mutInc + pM*mutScale <= 0 ) ) {
+        pE /= 2;
+        pM /= 2;
+    }
+
+    stepNorm = sqrt( pE*pE + pM*pM );
+    predicted = gE*pE + gM*pM - ( bEE*pE*pE + 2*bEM*pE*pM + bMM*pM*pM ) / 2;
+    etaaTrial = etaaInc + pE*etaaScale;
+    mutTrial = mutInc + pM*mutScale;
+    stepTaken = true;
+}
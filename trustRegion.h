@@ -0,0 +1,32 @@
+#include "checkEigenVals.h"
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <math.h>
+
+using namespace std;
+
+#pragma once
+
+class TrustRegion {
+    public:
+    TrustRegion();
+    TrustRegion( double, double, double, double, double );
+    bool update( const vector<vector<vector<double> > >&, const vector<double>&,
+        const vector<double>&, bool, vector<double>&, ostream& );
+    double etaaTrial;
+    double mutTrial;
+    double etaaInc;
+    double mutInc;
+
+    private:
+    double radius;
+    double predicted;
+    double stepNorm;
+    double etaaScale;
+    double mutScale;
+    vector<double> grad;
+    vector<double> hess;
+    bool stepTaken;
+    void takeStep();
+};
@@ -6,7 +6,7 @@
 time around the control loop. UpdateInterval finds the discrete maximum of the
 likelihood grid and fits a paraboloid around it on the last iteration. It
 calls findRegion to obtain the new discrete bounds for the confidence interval.
-Finally, it updates and prints the new range of eta_a and mu_t. */
+Finally, it updates the range of eta_a and mu_t, and prints it to progress. */
 
 /* Variables:
     dmut, detaa: The difference between each entry in the mut and etaa vectors
@@ -18,7 +18,7 @@ Finally, it updates and prints the new range of eta_a and mu_t. */
 /******************************************************************************/
 
 bool updateInterval( const vector<vector<double> >& likGrid, vector<double>& storeParab,
-    vector<double>& mutVec, vector<double>& etaaVec, bool last ) {
+    vector<double>& mutVec, vector<double>& etaaVec, bool last, ostream& progress ) {
 
     int mutSize = mutVec.size();
     int etaaSize = etaaVec.size();
@@ -31,13 +31,13 @@ bool updateInterval( const vector<vector<double> >& likGrid, vector<double>& sto
     detaa = ( etaaVec.back() - etaaVec.front() ) / ( etaaSize - 1 );
 
     /* Find the discrete maximum of likGrid. Quit program if there is none. */
-    if ( !discMax( likGrid, i0, j0, mutSize, etaaSize ) ) {
+    if ( !discMax( likGrid, i0, j0, mutSize, etaaSize, true ) ) {
         return false;
     }
 
     /* On the last region, find the entire confidence paraboloid */
     if ( last ) {
-        return contour( likGrid, storeParab, etaaVec, mutVec, i0, j0 );
+        return contour( likGrid, storeParab, etaaVec, mutVec, i0, j0, &progress );
     }
 
     findRegion( likGrid, iMin, iMax, jMin, jMax, i0, j0 );
@@ -57,10 +57,10 @@ bool updateInterval( const vector<vector<double> >& likGrid, vector<double>& sto
     }
 
     /* Print out new search interval */
-    cout << "mu_t bounds: (" << setprecision( 3 ) << mutVec.front() << ", " <<
+    progress << "mu_t bounds: (" << setprecision( 3 ) << mutVec.front() << ", " <<
         setprecision( 3 ) <<  mutVec.back() << ")" << endl;
 
-    cout << "eta_a bounds: (" << setprecision( 3 ) << etaaVec.front() << ", "
+    progress << "eta_a bounds: (" << setprecision( 3 ) << etaaVec.front() << ", "
         << setprecision( 3 ) << etaaVec.back() << ")" << endl << endl;
 
     return true;
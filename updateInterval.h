@@ -10,4 +10,4 @@ using namespace std;
 #pragma once
 
 bool updateInterval( const vector<vector<double> >&, vector<double>&, vector<double>&,
-    vector<double>&, bool );
+    vector<double>&, bool, ostream& );
@@ -1,24 +1,36 @@
 #include "weight.h"
 
 /* Weight is an object that contains all information about a particle's weight and the
-Importance sampling weighting functions. It is a member of the Particle class. */
+Importance sampling weighting functions. It is a member of the Particle class. The
+importance sampling weights only depend on how many collisions the particle had and
+how far it travelled in each layer, so the particle carries these counts and the
+weight vectors are only evaluated when it is detected. */
 
 /* Members:
     wScale: Scalar weight, to account for attenuation efficiently. Updated in scatter.
+    numColl, pathLen: Number of collisions and total path length in each layer
+    mutRef, etaaRef: Reference mut and etaa of each layer, that the particle is simulated at
     weightEtaa, weight mut: Vectors holding the importance sampling weight for each etaa and mut
+        combination over all layers (the first layer varies slowest)
     weightMatrix: 2D vector that holds the total weight over the entire grid of etaa, mut combos
-    etaaVec, mutVec: Vectors of etaa and mut values to search through (inverse problem)
+    etaaVec, mutVec: Vectors of etaa and mut values of each layer to search through (inverse problem)
+    weightN: Importance sampling weight for each index of refraction in nVec (empty if
+        the index is not scanned)
+    weightNInit: Ratio of specular transmission at each index in nVec to the reference one
 */
 
 /******************************************************************************/
 
-/* Default constructor: sets etaa to 10, mut to 100, and all weights to 1. */
+/* Default constructor: one layer with etaa at 0.1, mut at 1, and all weights to 1. */
 Weight::Weight() {
     vector<double> storeVec( 5, 1 );
-    mutVec = storeVec;
-    etaaVec = storeVec;
-    fill(mutVec.begin(), mutVec.end(), 1.0);
-    fill(etaaVec.begin(), etaaVec.end(), 0.1);
+    mutVec.assign( 1, storeVec );
+    etaaVec.assign( 1, storeVec );
+    fill(etaaVec.at(0).begin(), etaaVec.at(0).end(), 0.1);
+    mutRef.assign( 1, 1.0 );
+    etaaRef.assign( 1, 0.1 );
+    numColl.assign( 1, 0 );
+    pathLen.assign( 1, 0 );
     weightEtaa = storeVec;
     weightMut = storeVec;
     vector<vector<double> > storeMatrix(weightMut.size(),vector<double> (weightEtaa.size(), 0));
@@ -26,54 +38,124 @@ Weight::Weight() {
     wScale = 1;
 }
 
-/* Overload constructor: sets etaa and mut from inputs, sets all weights to 1. */
-Weight::Weight(vector<double>& mutV, vector<double>& etaaV) {
+/* Overload constructor: sets etaa and mut of each layer from inputs, sets all weights to 1. */
+Weight::Weight(vector<vector<double> >& mutV, vector<vector<double> >& etaaV) {
+    unsigned int mutSize = 1, etaaSize = 1;
     mutVec = mutV;
     etaaVec = etaaV;
-    weightMut = mutVec;
-    weightEtaa = etaaVec;
+    for ( unsigned int l = 0; l < mutVec.size(); l++ ) {
+        mutSize *= mutVec.at(l).size();
+        etaaSize *= etaaVec.at(l).size();
+    }
+    mutRef.assign( mutVec.size(), 1.0 );
+    etaaRef.assign( mutVec.size(), 0.0 );
+    numColl.assign( mutVec.size(), 0 );
+    pathLen.assign( mutVec.size(), 0 );
+    weightMut.assign( mutSize, 1 );
+    weightEtaa.assign( etaaSize, 1 );
     vector<vector<double> > storeMatrix(weightMut.size(),vector<double> (weightEtaa.size(), 0));
     weightMatrix = storeMatrix;
-    fill(weightEtaa.begin(),weightEtaa.end(),1);
-    fill(weightMut.begin(),weightMut.end(),1);
     wScale = 1;
 }
 
-/* Resets all weights to 1. */
+/* Resets all counts to zero and the index weights to their specular transmission ratios. */
 void Weight::reset(double T) {
-    fill(weightEtaa.begin(),weightEtaa.end(),1);
-    fill(weightMut.begin(),weightMut.end(),1);
+    fill(numColl.begin(),numColl.end(),0);
+    fill(pathLen.begin(),pathLen.end(),0);
+    weightN = weightNInit;
     wScale = T;
 }
 
-/* Updates vector of adjusted etaa weights */
-void Weight::updateWeightEtaa( double divVal ) {
-    for( unsigned int j = 0; j < weightEtaa.size(); j++ ) {
-        weightEtaa.at(j) *= (1 - etaaVec.at(j)) * divVal;
+/* Sets the reference mut and etaa of each layer from the layers the particle is simulated in. */
+void Weight::setReference( vector<Layer>& layerVec ) {
+    for ( unsigned int l = 0; l < mutRef.size(); l++ ) {
+        mutRef.at(l) = layerVec.at(l).getMut();
+        etaaRef.at(l) = layerVec.at(l).getMua() / layerVec.at(l).getMut();
     }
 }
 
-/* Updates vector of mut weights in the case where the particle does not hit a
-boundary. */
-void Weight::updateWeightMut( double mut0, double t ) {
-    for( unsigned int k = 0; k < weightMut.size(); k++ ) {
-        weightMut.at(k) *= ( mutVec.at(k) / mut0 * exp( t * (mut0 - mutVec.at(k)) ) );
+/* Sets the indices of refraction to reweight to. The particle is simulated at the
+reference index n0, so each index only changes the specular transmission and the
+reflect/transmit decisions at the boundaries. */
+void Weight::setNGrid( const vector<double>& nV, double n0 ) {
+    double kz2;
+    double T0 = 1 - fresnelR( 1, n0, 1, kz2 );
+    nVec = nV;
+    weightNInit.resize( nVec.size() );
+    for( unsigned int k = 0; k < nVec.size(); k++ ) {
+        weightNInit.at(k) = ( 1 - fresnelR( 1, nVec.at(k), 1, kz2 ) ) / T0;
     }
+    weightN = weightNInit;
+}
+
+/* Updates vector of index weights at a boundary with a medium of index nOut. The
+weight is the likelihood ratio of the sampled decision, reflected or transmitted,
+at each index to that at the reference index n0. */
+void Weight::updateWeightN( double kz, double n0, double nOut, bool reflected ) {
+    double kz2;
+    double R0 = fresnelR( n0, nOut, kz, kz2 );
+    for( unsigned int k = 0; k < weightN.size(); k++ ) {
+        double R = fresnelR( nVec.at(k), nOut, kz, kz2 );
+        if ( reflected ) {
+            weightN.at(k) *= R / R0;
+        }
+        else {
+            weightN.at(k) *= ( 1 - R ) / ( 1 - R0 );
+        }
+    }
+}
+
+/* Counts a collision in the case where the particle does not hit a boundary.
+Each such step contributes mut/mut0 * exp( t*(mut0 - mut) ) to the mut weights
+and (1 - etaa)/(1 - etaa0) to the etaa weights. */
+void Weight::updateWeightMut( unsigned int layer, double t ) {
+    numColl.at(layer)++;
+    pathLen.at(layer) += t;
 }
 
-/* Updates vector of mut weights in boundary case. On the probability distribution,
+/* Counts the step in the boundary case. On the probability distribution,
 the boundary case represents a delta function scaled by the integral from position
 d to infinity of the exponential distribution (because all values beyond d are relocated
-into d). This integral is equal to exp( - t*mut ). */
-void Weight::updateWtBound( double mut0, double t ) {
-    for( unsigned int k = 0; k < weightMut.size(); k++ ) {
-        weightMut.at(k) *= ( exp( t * (mut0 - mutVec.at(k)) ) );
+into d). This integral is equal to exp( - t*mut ), so the step only adds to the path length. */
+void Weight::updateWtBound( unsigned int layer, double t ) {
+    pathLen.at(layer) += t;
+}
+
+/* Updates weightMut and weightEtaa by evaluating the mut and etaa weight vectors of each
+layer from its counts and combining the layers. */
+void Weight::updateVectors() {
+    unsigned int mutSize = 1, etaaSize = 1;
+    double mut0, k, t;
+    weightMut.at(0) = 1;
+    weightEtaa.at(0) = 1;
+
+    for ( unsigned int l = 0; l < mutVec.size(); l++ ) {
+        mut0 = mutRef.at(l);
+        k = numColl.at(l);
+        t = pathLen.at(l);
+
+        /* Combine with the previous layers, with this layer varying fastest */
+        for ( int a = mutSize - 1; a >= 0; a-- ) {
+            for ( int b = mutVec.at(l).size() - 1; b >= 0; b-- ) {
+                weightMut.at( a*mutVec.at(l).size() + b ) = weightMut.at(a) *
+                    pow( mutVec.at(l).at(b) / mut0, k ) * exp( t * ( mut0 - mutVec.at(l).at(b) ) );
+            }
+        }
+        for ( int a = etaaSize - 1; a >= 0; a-- ) {
+            for ( int b = etaaVec.at(l).size() - 1; b >= 0; b-- ) {
+                weightEtaa.at( a*etaaVec.at(l).size() + b ) = weightEtaa.at(a) *
+                    pow( ( 1 - etaaVec.at(l).at(b) ) / ( 1 - etaaRef.at(l) ), k );
+            }
+        }
+        mutSize *= mutVec.at(l).size();
+        etaaSize *= etaaVec.at(l).size();
     }
 }
 
-/* Updates weightMatrix by taking the outer product of weightEtaa and weightMut and
-multiplying elementwise by scalar wScale. */
+/* Updates weightMatrix to the outer product of weightEtaa and weightMut multiplied
+elementwise by scalar wScale. */
 void Weight::updateMatrix() {
+    updateVectors();
     for( unsigned int i = 0; i < weightMut.size(); i++ ) {
         for ( unsigned int j = 0; j < weightEtaa.size(); j++ ) {
             weightMatrix.at(i).at(j) = weightMut.at(i)*weightEtaa.at(j)*wScale;
@@ -1,3 +1,5 @@
+#include "fresnelR.h"
+#include "layer.h"
 #include <math.h>
 #include<vector>
 
@@ -8,16 +10,26 @@ using namespace std;
 class Weight {
     public:
     Weight();
-    Weight(vector<double>&, vector<double>&);
+    Weight(vector<vector<double> >&, vector<vector<double> >&);
     double wScale;
+    vector<unsigned int> numColl;
+    vector<double> pathLen;
+    vector<double> mutRef;
+    vector<double> etaaRef;
     vector<double> weightEtaa;
     vector<double> weightMut;
     vector<vector<double> > weightMatrix;
-    vector<double> mutVec;
-    vector<double> etaaVec;
+    vector<vector<double> > mutVec;
+    vector<vector<double> > etaaVec;
+    vector<double> weightN;
+    vector<double> weightNInit;
+    vector<double> nVec;
     void reset( double );
-    void updateWeightEtaa( double );
-    void updateWeightMut( double, double );
-    void updateWtBound( double, double );
+    void setReference( vector<Layer>& );
+    void setNGrid( const vector<double>&, double );
+    void updateWeightMut( unsigned int, double );
+    void updateWtBound( unsigned int, double );
+    void updateWeightN( double, double, double, bool );
+    void updateVectors();
     void updateMatrix();
 };